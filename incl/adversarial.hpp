@@ -0,0 +1,45 @@
+#ifndef ADVERSARIAL_HPP
+#define ADVERSARIAL_HPP
+
+#include "graph.hpp"
+#include <utility>
+#include <vector>
+
+namespace gen
+{
+    // Workload is an input built to be slow for the ES structure: the graph, the root to build the structure from, and the
+    // deletions in order, as the (v, u) to pass to reorg_after_remove after removing the edge
+    struct Workload
+    {
+        Vertex root;
+        std::vector<std::pair<Vertex, Vertex>> deletions;
+    };
+
+    // halving_sequence returns the vertices v of a line of n vertices (n a power of two), such that removing the edges (v, v - 1)
+    // in that order halves every line segment, making it the worst case for process A
+    std::vector<Vertex> halving_sequence(int n);
+
+    // The adversarial workloads below are built from bundles: layers of width vertices, every vertex joined to every vertex
+    // of the next layer, so that every vertex has width parents in alpha and the level changes of a layer reach the whole
+    // next one. With width 1 the bundles are paths and the workloads are the classic worst cases for a line and a ring.
+
+    // adversarial_level_bumps maximises the level increases of Process B: a ring of layers bundles through the root,
+    // deleting the width edges from the root to the first layer. The last deletion makes the half of the ring closest to
+    // the cut climb to the far side, about width * layers^2 / 4 level increases moving width^2 * layers^2 / 4 edges, without
+    // disconnecting anything. n = 1 + width * layers, m = 2 * width + (layers - 1) * width^2.
+    Workload adversarial_level_bumps(Graph &G, int layers, int width, std::vector<Edge> &edge_handles);
+
+    // adversarial_race maximises the time both processes run against each other: two bundles of layers layers hang off
+    // two hubs joined by a bridge, the root being one hub. Deleting the bridge splits the graph into equal halves, so
+    // Process A has to scan a whole half, about m / 2 edges, while Process B keeps raising the levels of the half that broke
+    // off. Everything Process B did is then rewound. n = 2 * (1 + width * layers), m = 2 * (width + (layers - 1) * width^2) + 1.
+    Workload adversarial_race(Graph &G, int layers, int width, std::vector<Edge> &edge_handles);
+
+    // adversarial_halving maximises the total rewind volume: a line of segments cliques of width vertices, neighbouring
+    // cliques joined by a single edge, cut in halving order (segments a power of two). Every deletion splits a run of
+    // cliques into equal halves, so every deletion is a full race whose Process B work gets rewound, about m log(segments)
+    // in total. The root is the first vertex. n = segments * width, m = segments * width * (width - 1) / 2 + segments - 1.
+    Workload adversarial_halving(Graph &G, int segments, int width, std::vector<Edge> &edge_handles);
+}
+
+#endif
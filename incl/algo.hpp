@@ -4,6 +4,8 @@
 #include "graph.hpp"
 #include "edge_set.hpp"
 #include "change_record.hpp"
+#include "counters.hpp"
+#include "state_allocator.hpp"
 #include <stack>
 #include <queue>
 #include <list>
@@ -16,13 +18,20 @@ namespace my
     // bfs performs the BFS algorithm and keeps track of the levels, starting with a root level of "levels_offset". It
     // also marks the component discovered and keeps track of edge sets (unordered_map) for each vertex to the previous (alpha), current(beta),
     // and next (gamma) levels.
-    void bfs(const Graph &G, Vertex s, std::vector<int> &levels, std::vector<int> &comp, int comp_val,
-             std::vector<EdgeSet> &alpha,
-             std::vector<EdgeSet> &beta,
-             std::vector<EdgeSet> &gamma,
+    void bfs(const Graph &G, Vertex s, my::StateVector<int> &levels, my::StateVector<int> &comp, int comp_val,
+             my::StateVector<EdgeSet> &alpha,
+             my::StateVector<EdgeSet> &beta,
+             my::StateVector<EdgeSet> &gamma,
              int levels_offset = 0);
 
-    void dfs(const Graph &G, Vertex s, std::vector<int> &comp, int comp_val);
+    void dfs(const Graph &G, Vertex s, my::StateVector<int> &comp, int comp_val);
+    // bfs_farthest performs a BFS from s and returns the last vertex discovered, which is at maximum distance from s.
+    // parent holds the BFS tree afterwards, with parent[s] == s. Vertices not reached keep the value num_vertices(G).
+    Vertex bfs_farthest(const Graph &G, Vertex s, std::vector<Vertex> &parent);
+    // approximate_center picks a vertex close to the center of the component of s with a double-sweep BFS:
+    // the middle of the path between the endpoints of the second sweep
+    Vertex approximate_center(const Graph &G, Vertex s);
+    Vertex highest_degree_vertex(const Graph &G);
     bool dfs_scan(const Graph &G, Vertex s, Vertex t);
     void dfs_tree(const Graph &G, Vertex s, std::vector<Edge> &tree_edges);
 
@@ -74,7 +83,7 @@ namespace my
         void _init();
     };
 
-    void circuit_free_update_components(const Graph &G, Vertex u, Vertex v, std::vector<int> &comps, int new_comp_val);
+    void circuit_free_update_components(const Graph &G, Vertex u, Vertex v, my::StateVector<int> &comps, int new_comp_val);
 
     enum class StepDetectBreakState
     {
@@ -96,12 +105,16 @@ namespace my
         StepDetectBreakState state;
         std::list<Vertex> small_component;
 
-        StepDetectBreak(const Graph &G, Vertex u, Vertex v);
+        // branch_quantum is the number of steps a DFS branch takes before switching to the other branch.
+        // counters, if given, receives the steps of each branch (see ReorgCounters).
+        StepDetectBreak(const Graph &G, Vertex u, Vertex v, int branch_quantum = 1, ReorgCounters *counters = nullptr);
 
         void advance();
 
     private:
         const Graph &_G;
+        int _branch_quantum;
+        ReorgCounters *_counters;
         // one stepDFS for each of the two subtrees, running in "parallel"
         StepScanDFS sdfs1;
         StepScanDFS sdfs2;
@@ -128,18 +141,26 @@ namespace my
     public:
         bool component_breaks;
         StepDetectNotBreakState state;
+        // level_bumps counts the level increases performed so far, whether they were recorded or not
+        std::size_t level_bumps;
 
         StepDetectNotBreak() = default;
-        StepDetectNotBreak(std::vector<int> &levels,
-                           std::vector<EdgeSet> &alpha,
-                           std::vector<EdgeSet> &beta,
-                           std::vector<EdgeSet> &gamma,
+        StepDetectNotBreak(my::StateVector<int> &levels,
+                           my::StateVector<EdgeSet> &alpha,
+                           my::StateVector<EdgeSet> &beta,
+                           my::StateVector<EdgeSet> &gamma,
                            std::stack<ChangeRecord> &changes_stack,
-                           Vertex u, Vertex v);
+                           Vertex u, Vertex v,
+                           ReorgCounters *counters = nullptr,
+                           std::vector<Vertex> *bumped = nullptr);
 
         void advance(bool record_changes);
 
     private:
+        ReorgCounters *_counters;
+        // if given, every vertex whose level is increased is appended, whether the increase is recorded or not
+        std::vector<Vertex> *_bumped;
+
         // _changes_stack holds a history of the changes made, used to rewind the changes in case process A
         // detects a break
         std::stack<ChangeRecord> &_changes_stack;
@@ -149,11 +170,11 @@ namespace my
         Vertex _u;
         Vertex _v;
 
-        std::vector<int> &_levels;
+        my::StateVector<int> &_levels;
         // an alpha/beta/gamma set for each vertex
-        std::vector<EdgeSet> &_alpha;
-        std::vector<EdgeSet> &_beta;
-        std::vector<EdgeSet> &_gamma;
+        my::StateVector<EdgeSet> &_alpha;
+        my::StateVector<EdgeSet> &_beta;
+        my::StateVector<EdgeSet> &_gamma;
 
         Vertex _current_w;
         EdgeSetIterator _current_esi;
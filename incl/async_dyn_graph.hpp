@@ -0,0 +1,85 @@
+#ifndef ASYNC_DYN_GRAPH_HPP
+#define ASYNC_DYN_GRAPH_HPP
+
+#include "graph.hpp"
+#include "dyn_graph.hpp"
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <thread>
+
+// AsyncDynGraph puts a submission queue in front of a DynGraph. Any number of threads can submit deletions and queries, which a
+// single engine thread applies in submission order, in batches. Every submission returns a future.
+//
+// A query is answered on the submitting thread, without going through the queue, whenever the answer cannot depend on a pending
+// deletion: if the two vertices are in different components they stay disconnected, since edges are never inserted, and if no
+// deletion is pending the components are final. The components are read under a sequence counter that the engine makes odd
+// while a deletion is being applied.
+//
+// The DynGraph and its Graph are owned by the engine thread for the lifetime of the AsyncDynGraph and must not be used directly.
+// Background rebuilds, re-rooting, init and forks replace the component array read by the query fast path, so the constructor
+// asserts that none is running or enabled, and the DynGraph asserts that none starts until the AsyncDynGraph is destroyed.
+// With a compaction policy set on the DynGraph, the engine thread compacts the edge sets whenever the queue is empty.
+class AsyncDynGraph
+{
+public:
+    AsyncDynGraph(Graph &G, DynGraph &DG, std::size_t batch_size = 64);
+    // applies everything submitted so far, then stops the engine thread
+    ~AsyncDynGraph();
+
+    std::future<void> submit_delete(Edge e);
+    // deletes one edge between u and v, the future holds std::invalid_argument if there is none
+    std::future<void> submit_delete(Vertex u, Vertex v);
+    std::future<bool> submit_query(Vertex u, Vertex v);
+
+private:
+    // vertices compacted between two checks of the queue while idle
+    static constexpr std::size_t IDLE_COMPACTION_SLICE = 1024;
+
+    enum class OpType
+    {
+        DeleteEdge,
+        DeleteEndpoints,
+        Query,
+    };
+
+    // Op is a node of the intrusive multi-producer single-consumer queue
+    struct Op
+    {
+        OpType type;
+        Edge e;
+        Vertex u;
+        Vertex v;
+        std::promise<void> done;
+        std::promise<bool> answer;
+        std::atomic<Op *> next;
+    };
+
+    Graph &_G;
+    DynGraph &_DG;
+    std::size_t _batch_size;
+
+    // queue: producers exchange _head, the engine thread owns _tail (Vyukov MPSC queue with a stub node)
+    std::atomic<Op *> _head;
+    Op *_tail;
+    Op _stub;
+
+    // incremented on every push, the engine thread waits on it when the queue is empty
+    std::atomic<std::uint64_t> _signal;
+    std::atomic<bool> _stop;
+    // odd while the engine is applying a deletion
+    std::atomic<std::uint64_t> _seq;
+    // deletions submitted but not yet applied
+    std::atomic<std::size_t> _pending_deletes;
+
+    std::thread _engine;
+
+    void _push(Op *op);
+    Op *_pop();
+    void _run();
+    void _apply(Op *op);
+    // _try_answer answers a query from the current components if no pending deletion can change the answer
+    bool _try_answer(Vertex u, Vertex v, bool &answer);
+};
+
+#endif
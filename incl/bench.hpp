@@ -0,0 +1,96 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "latency.hpp"
+
+namespace bench
+{
+    // Config holds the command line options of the benchmark binary
+    struct Config
+    {
+        // suites to run, all of them if empty
+        std::vector<std::string> suites;
+        // cases overriding the defaults of every selected suite, each case is a list of parameters ("500x2000" -> {500, 2000})
+        std::vector<std::vector<long>> cases;
+        int iterations = 100;
+        // runs per case whose results are discarded, to warm up caches and the allocator
+        int warmup = 2;
+        std::uint64_t seed = 1072558;
+        std::string json_path = "../results/bench.json";
+        // directory of the per-query mean .dat files read by the plotting scripts, empty to skip them
+        std::string dat_dir = "../results";
+        // include the statistics of every query in the JSON output, not only the aggregate
+        bool per_query = false;
+        // runs performed in parallel, 0 for one per available physical core. Runs of a case are independent, but parallel
+        // runs share the last level cache and memory bandwidth, so absolute times may be higher than with a single job.
+        int jobs = 1;
+        // pin every benchmark thread to a physical core of its own, one cpu per core with its SMT siblings left idle, so runs
+        // neither migrate nor share a core while they are measured
+        bool pin = true;
+    };
+
+    // Times holds the measurements of one run: one row per query, one column per measured quantity (in Suite::unit)
+    typedef std::vector<std::vector<double>> Times;
+
+    // RunFn performs one run of a case. case_seed is derived from Config::seed and the case, so every run can be reproduced.
+    // Suites that need a different input for every iteration derive it from case_seed and iteration (see iteration_seed).
+    // Runs may be performed concurrently on several threads (Config::jobs), a RunFn must only use state local to the run.
+    typedef std::function<void(const std::vector<long> &params, std::uint64_t case_seed, int iteration, Times &times)> RunFn;
+
+    enum class DatFormat
+    {
+        PerQuery, // "<prefix>_<params>.dat", one line per query with the mean of every column
+        Total,    // "<prefix>.dat", the cases on the first line, then the mean of the first column of every case
+    };
+
+    struct Suite
+    {
+        std::string name;
+        std::string description;
+        std::vector<std::string> columns;
+        std::vector<std::vector<long>> default_cases;
+        RunFn run;
+        DatFormat dat_format;
+        // file name prefix of the .dat output, relative to Config::dat_dir
+        std::string dat_prefix;
+        // a deterministic suite measures something that does not vary between runs (e.g. memory), it runs once per case
+        // without warmup, whatever Config::iterations says
+        bool deterministic = false;
+        std::string unit = "ms";
+    };
+
+    struct Stats
+    {
+        std::size_t count;
+        double mean;
+        double p50;
+        double p90;
+        double p99;
+        double max;
+    };
+
+    // iteration_seed mixes a case seed with an iteration number
+    std::uint64_t iteration_seed(std::uint64_t case_seed, int iteration);
+
+    // compute_stats sorts the samples and returns nearest-rank percentiles
+    Stats compute_stats(std::vector<float> &samples);
+
+    // report_latency merges a histogram recorded during a run (e.g. DynGraph::reorg_latency) into the run on the calling
+    // thread, under the given name. The histograms of the measured iterations are merged per case and written to the JSON
+    // output, warmup runs are ignored.
+    void report_latency(const std::string &name, const my::LatencyHistogram &histogram);
+
+    // parse_args fills config from the command line, returns false and prints the usage on invalid input.
+    // list is set when the suites should only be listed.
+    bool parse_args(int argc, char **argv, Config &config, bool &list);
+    void print_suites(const std::vector<Suite> &suites);
+
+    // run runs the selected suites and writes their results, returns the process exit code
+    int run(const Config &config, const std::vector<Suite> &suites);
+}
+
+#endif
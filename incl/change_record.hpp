@@ -11,6 +11,7 @@ enum class ChangeRecordType
     AlphaBetaMove,
     RestoreBeta,
     GammaEmptyMove,
+    ComponentRelabel,
 };
 
 class ChangeRecord
@@ -19,7 +20,7 @@ public:
     ChangeRecordType type;
     Vertex v;        // considered the primary vertex concerned when dealing with edge sets
     Vertex u;        // ignored when not Insert or Remove
-    int primary_set; // 0: alpha, 1: beta, 2: gamma
+    int primary_set; // 0: alpha, 1: beta, 2: gamma. The previous component of v for ComponentRelabel
     EdgeSet old_set; // ignored when not AlphaBetaMove
 
     ChangeRecord(ChangeRecordType type, Vertex v, Vertex u, int primary_set);
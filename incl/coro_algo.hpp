@@ -0,0 +1,89 @@
+#ifndef CORO_ALGO_HPP
+#define CORO_ALGO_HPP
+
+#include "graph.hpp"
+#include "edge_set.hpp"
+#include "change_record.hpp"
+#include "counters.hpp"
+#include "state_allocator.hpp"
+#include <coroutine>
+#include <list>
+#include <stack>
+#include <vector>
+
+namespace my
+{
+    // StepTask is a coroutine that suspends after every batch of steps, so that two of them can be interleaved the same way
+    // the state machines in algo.hpp are interleaved with advance(). The loop state lives in the coroutine frame instead of
+    // being dispatched through a switch on every step.
+    class StepTask
+    {
+    public:
+        struct promise_type
+        {
+            StepTask get_return_object() { return StepTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            // nothing runs until the first advance, same as the state machines
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            // keep the frame alive after co_return so finished() can be queried
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception();
+        };
+
+        StepTask(StepTask &&other);
+        StepTask &operator=(StepTask &&other);
+        StepTask(const StepTask &) = delete;
+        ~StepTask();
+
+        // advance resumes the coroutine until it completes its next batch of steps, or finishes
+        void advance();
+        bool finished() const;
+
+    private:
+        std::coroutine_handle<promise_type> _h;
+
+        explicit StepTask(std::coroutine_handle<promise_type> h);
+    };
+
+    // ScanOutcome holds the result of coro_scan_dfs, with the same meaning as the StepScanDFS fields
+    struct ScanOutcome
+    {
+        bool result = false;
+        std::list<Vertex> component;
+    };
+
+    // BreakOutcome holds the result of coro_detect_break, with the same meaning as the StepDetectBreak fields
+    struct BreakOutcome
+    {
+        bool component_breaks = false;
+        std::list<Vertex> small_component;
+    };
+
+    // coro_scan_dfs is the coroutine version of StepScanDFS. Every advance performs "batch" of the steps StepScanDFS::advance performs.
+    // If counters is given, the steps are added to counters->a_steps[branch].
+    StepTask coro_scan_dfs(const Graph &G, Vertex s, Vertex t, bool target_mode, ScanOutcome &out, int batch = 1,
+                           ReorgCounters *counters = nullptr, int branch = 0);
+
+    // coro_detect_break is the coroutine version of StepDetectBreak (Process A). Every advance gives "batch" turns to the DFS
+    // branches, each turn being branch_quantum DFS steps.
+    StepTask coro_detect_break(const Graph &G, Vertex u, Vertex v, BreakOutcome &out, int branch_quantum = 1, int batch = 1,
+                               ReorgCounters *counters = nullptr);
+
+    // coro_detect_not_break is the coroutine version of StepDetectNotBreak (Process B). record_changes is read before every step,
+    // so the caller can switch recording off while the coroutine is suspended, like StepDetectNotBreak::advance(record_changes).
+    // level_bumps is set to zero and then counts the level increases, like StepDetectNotBreak::level_bumps, and bumped
+    // collects the vertices whose level is increased if given.
+    StepTask coro_detect_not_break(my::StateVector<int> &levels,
+                                   my::StateVector<EdgeSet> &alpha,
+                                   my::StateVector<EdgeSet> &beta,
+                                   my::StateVector<EdgeSet> &gamma,
+                                   std::stack<ChangeRecord> &changes_stack,
+                                   Vertex u, Vertex v,
+                                   const bool &record_changes,
+                                   std::size_t &level_bumps,
+                                   int batch = 1,
+                                   ReorgCounters *counters = nullptr,
+                                   std::vector<Vertex> *bumped = nullptr);
+}
+
+#endif
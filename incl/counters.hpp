@@ -0,0 +1,54 @@
+#ifndef COUNTERS_HPP
+#define COUNTERS_HPP
+
+#include <cstdint>
+
+namespace my
+{
+    // number of StepDetectNotBreakState values, b_steps is indexed by state
+    const int NUM_PROCESS_B_STATES = 11;
+
+    // ReorgCounters counts the work performed by the reorganization after a deletion. The counters are only maintained when
+    // building with -DDYN_COUNTERS (make COUNTERS=1), otherwise DYN_COUNT expands to nothing and they stay zero.
+    struct ReorgCounters
+    {
+        std::uint64_t deletions;
+        // Process A steps of each DFS branch, the one starting from u and the one starting from v
+        std::uint64_t a_steps[2];
+        // Process B steps, per StepDetectNotBreakState the step started in
+        std::uint64_t b_steps[NUM_PROCESS_B_STATES];
+        std::uint64_t level_bumps;
+        // single edges moved between alpha, beta and gamma sets (avalanche steps 4 and 6)
+        std::uint64_t edges_moved;
+        // whole sets moved between roles (avalanche steps 5 and 7)
+        std::uint64_t sets_moved;
+        std::uint64_t records_pushed;
+        std::uint64_t records_rewound;
+        // size of the component that broke off, 0 if none did
+        std::uint64_t small_component_size;
+
+        ReorgCounters();
+        void reset();
+        ReorgCounters &operator+=(const ReorgCounters &other);
+        std::uint64_t total_a_steps() const;
+        std::uint64_t total_b_steps() const;
+    };
+}
+
+#ifdef DYN_COUNTERS
+#define DYN_COUNT(counters, field, n)      \
+    do                                     \
+    {                                      \
+        if ((counters) != nullptr)         \
+        {                                  \
+            (counters)->field += (n);      \
+        }                                  \
+    } while (0)
+#else
+#define DYN_COUNT(counters, field, n) \
+    do                                \
+    {                                 \
+    } while (0)
+#endif
+
+#endif
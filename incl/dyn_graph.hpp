@@ -4,36 +4,313 @@
 #include "graph.hpp"
 #include "edge_set.hpp"
 #include <stack>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include "algo.hpp"
 #include "change_record.hpp"
+#include "scheduler.hpp"
+#include "counters.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
+#include "memory_usage.hpp"
+#include "phase_trace.hpp"
+#include "state_allocator.hpp"
+#include "shared_components.hpp"
+#include "spanning_forest.hpp"
+
+// ReorgEngine selects the implementation of Process A and Process B used by reorg_after_remove
+enum class ReorgEngine
+{
+    StateMachine, // the step classes in algo.hpp
+    Coroutine,    // the coroutines in coro_algo.hpp
+};
+
+// RootStrategy selects the root of the ES tree. A root close to the center of the graph keeps the tree shallow,
+// which bounds the number of level increases Process B can perform.
+enum class RootStrategy
+{
+    Fixed,         // keep the current root
+    Random,        // uniformly random vertex
+    HighestDegree, // vertex with the most incident edges
+    Center,        // approximate center of the component of the highest degree vertex, found with a double-sweep BFS
+};
+
+class DynGraphFork;
 
 class DynGraph
 {
+private:
+    // under a non-default memory policy, the arena the hash tables of the edge sets are carved from, null otherwise. It is
+    // declared before the sets, which give their tables back to it when they are destroyed.
+    std::unique_ptr<my::RegionArena> _edge_arena;
+
 public:
-    std::vector<int> _levels;
-    std::vector<int> _components;
-    std::vector<EdgeSet> alpha;
-    std::vector<EdgeSet> beta;
-    std::vector<EdgeSet> gamma;
+    // the per-vertex state, allocated under the memory policy given at construction
+    my::StateVector<int> _levels;
+    my::StateVector<int> _components;
+    my::StateVector<EdgeSet> alpha;
+    my::StateVector<EdgeSet> beta;
+    my::StateVector<EdgeSet> gamma;
 
     DynGraph(Graph &G);
-    DynGraph(Graph &G, Vertex r);
+    // memory selects huge pages and NUMA placement for the per-vertex arrays, or file backed arrays for graphs whose state
+    // does not fit in RAM, see MemoryPolicy. The hash tables of the edge sets too large to be stored inline follow the
+    // arrays under any policy other than the default: they are carved from a RegionArena whose chunks are mapped with the
+    // same pages, NUMA placement or files. What stays on the heap in any mode is the boost graph (its vertex vector,
+    // out-edge lists and edge list), the change log, the endpoint index and the buffers of a background rebuild.
+    DynGraph(Graph &G, Vertex r, const my::MemoryPolicy &memory = my::MemoryPolicy());
+    DynGraph(Graph &G, RootStrategy strategy, const my::MemoryPolicy &memory = my::MemoryPolicy());
     void init(bool random_root);
+    void init(RootStrategy strategy);
     void print();
     void dyn_remove_edge(Edge e);
+    // dyn_remove_edge removes an edge between u and v and reorganizes like dyn_remove_edge(edge(u, v, G).first), in O(1)
+    // expected time for the lookup and the graph mutation instead of a scan of the out-edges of u and v. It uses an index
+    // of every edge by its endpoints, built by the first call or by build_edge_index. Returns false if there is no edge.
+    bool dyn_remove_edge(Vertex u, Vertex v);
+    // build_edge_index builds the endpoint index in O(m) now rather than on the first deletion by endpoints. Edges removed
+    // with reorg_after_remove or either dyn_remove_edge keep it up to date, edges must not be added to the graph afterwards.
+    void build_edge_index();
     void reorg_after_remove(Vertex v, Vertex u);
     bool query_is_connected(Vertex v, Vertex u);
     bool query_is_connected(Edge e);
+    // would_disconnect tells whether deleting e would split its component, without deleting it. The deletion runs as usual
+    // with every change recorded, then the changes are rewound and the edge goes back in place, so the graph, its edge
+    // descriptors and the ES structure are left as they were. It costs what the deletion costs, not a copy of the graph.
+    bool would_disconnect(Edge e);
+    // would_disconnect(edges, u, v) tells whether u and v would be disconnected after deleting all of edges, in that order,
+    // and restores everything the same way. The edges have to be distinct.
+    bool would_disconnect(const std::vector<Edge> &edges, Vertex u, Vertex v);
+    // fork returns an independent branch of the current state, which shares the graph and the state with this DynGraph and
+    // copies what its own deletions touch. This DynGraph must not change while the fork exists, see dyn_graph_fork.hpp.
+    DynGraphFork fork();
+    // reclaim_state puts the state and the graph of this DynGraph back in place if the last fork to delete an edge left its
+    // own there (see dyn_graph_fork.hpp). Every other call does it when needed, only direct reads of the graph need it.
+    void reclaim_state();
+    // connecting_path returns a path from u to v, both included, or an empty one if they are not connected. It goes up the
+    // BFS tree (see spanning_forest) from both ends to their closest common ancestor, in O(path length), so it has at most
+    // as many edges as the levels of u and v above that ancestor, and is not always a shortest path.
+    std::vector<Vertex> connecting_path(Vertex u, Vertex v);
+    // spanning_forest returns the edges from every vertex to its parent in the BFS tree, one alpha edge each, which span
+    // every component. The range is valid until the next deletion.
+    SpanningForest spanning_forest();
 
     Vertex get_root();
+    // set_scheduler replaces the policy interleaving Process A and Process B, see StepScheduler
+    void set_scheduler(const my::StepScheduler &scheduler);
+    const my::StepScheduler &get_scheduler();
+    void set_engine(ReorgEngine engine);
+    // set_reroot_policy enables rebuilding the ES tree from a root picked with the given strategy, once at least min_deletions
+    // deletions have happened since the last init and the average level has grown past drift_factor times the average level
+    // right after that init. A drift_factor of 0 disables the policy (the default). With background set, the rebuild is done
+    // with start_background_rebuild instead of blocking on init.
+    void set_reroot_policy(double drift_factor, std::size_t min_deletions, RootStrategy strategy = RootStrategy::Center,
+                           bool background = false);
+    double average_level();
+    // last_counters holds the work of the most recent deletion, total_counters the sum since construction or the last
+    // reset_counters. Both stay zero unless built with -DDYN_COUNTERS (make COUNTERS=1).
+    const my::ReorgCounters &last_counters();
+    const my::ReorgCounters &total_counters();
+    void reset_counters();
+    // reorg_latency and query_latency return a snapshot of the durations of reorg_after_remove (and dyn_remove_edge) and
+    // query_is_connected, in clock_ticks. They are recorded unless disabled with set_latency_tracking(false), and are read
+    // by the thread performing the operations.
+    my::LatencyHistogram reorg_latency();
+    my::LatencyHistogram query_latency();
+    // duration of the most recent reorganization, in clock_ticks, also kept when tracking is disabled
+    std::uint64_t last_reorg_ticks();
+    void reset_latency();
+    void set_latency_tracking(bool enabled);
+    // start_trace records the workload into a binary trace at path (see trace.hpp): the current graph, root, engine and
+    // trace_settings, then every deletion. Replaying gives the same work only when started right after construction or init,
+    // since the replay starts from a fresh BFS, and when the settings are not changed while the trace runs. Returns false if
+    // path cannot be written, or if a background rebuild is running or the reroot policy is enabled with background
+    // rebuilds or a random root, which a replay could not repeat.
+    bool start_trace(const std::string &path);
+    void stop_trace();
+    // trace_settings returns the scheduler, reroot policy and compaction policy as start_trace records them,
+    // apply_trace_settings puts back the ones read from a trace before replaying it
+    my::TraceSettings trace_settings();
+    void apply_trace_settings(const my::TraceSettings &settings);
+    // start_phase_trace times every init and deletion, the scheduler turns of Process A and Process B and the rewind, and
+    // writes them as a Chrome trace to path when stopped (see PhaseTracer). While no phase trace runs, the phases cost a
+    // pointer check each. Returns false if path cannot be written.
+    bool start_phase_trace(const std::string &path, std::size_t max_events = 1 << 20);
+    // stop_phase_trace writes the trace file, returns false if no phase trace was running or writing failed
+    bool stop_phase_trace();
+    const my::MemoryPolicy &memory_policy();
+    // set_compaction_policy enables the incremental compaction of alpha, beta and gamma. A set is shrunk when its load factor
+    // is below min_load_factor or it fits inline again (see EdgeSet::shrink). After every deletion, the sets of the next
+    // vertices_per_deletion vertices are visited, round robin, once the deletion has been timed; with 0 the compaction only
+    // runs in compact_edge_sets. Whenever a full pass has released trim_bytes or more, malloc_trim gives the free heap pages
+    // back to the system. It walks the whole heap, so it only runs in compact_edge_sets, never during a deletion.
+    // A min_load_factor of 0 disables the policy (the default).
+    void set_compaction_policy(double min_load_factor, std::size_t vertices_per_deletion, std::size_t trim_bytes = 1 << 20);
+    // compact_edge_sets runs the compaction on the next vertices vertices now, and the malloc_trim of the last full pass if
+    // it is still due, for callers that have idle time, like the
+    // engine thread of AsyncDynGraph. Returns the number of bytes released.
+    std::size_t compact_edge_sets(std::size_t vertices);
+    // compaction_pending tells whether the policy is enabled and a pass is under way or deletions happened since the last
+    // full pass started
+    bool compaction_pending();
+    const my::CompactionStats &compaction_stats();
+    // start_publishing publishes the components, and the levels if with_levels is set, into the POSIX shared memory segment
+    // name (see SharedComponentsWriter). The segment is filled now and after every init, and every deletion writes only the
+    // entries it changed, so processes with a SharedComponentsReader answer queries without going through this one.
+    // Returns false with a message in error if the segment cannot be created.
+    bool start_publishing(const std::string &name, bool with_levels, std::string &error);
+    // stop_publishing removes the segment
+    void stop_publishing();
+    // memory_usage estimates the heap bytes of the graph and of every part of the ES structure, see MemoryUsage
+    my::MemoryUsage memory_usage();
+
+    // start_background_rebuild builds a fresh ES tree from a snapshot of the graph on a separate thread. Deletions that arrive
+    // meanwhile are applied to the current structure as usual and buffered for the rebuilt one. Once the rebuilt structure has
+    // caught up, it replaces the current one at the start of the next deletion. Returns false if a rebuild is already running.
+    // The snapshot is taken on the calling thread and costs a pass over the edge list.
+    bool start_background_rebuild(RootStrategy strategy = RootStrategy::Center);
+    // finish_background_rebuild swaps in the rebuilt structure if it is ready, or waits for it first if wait is set.
+    // Returns true if a swap took place.
+    bool finish_background_rebuild(bool wait = false);
+    bool rebuild_in_progress();
+
+    ~DynGraph();
 
 private:
+    friend class DynGraphFork;
+    friend class AsyncDynGraph;
+
     Graph &_G;
     Vertex _r;
     int _component_max_idx;
+    my::MemoryPolicy _memory;
+    my::StepScheduler _scheduler;
+    ReorgEngine _engine;
     std::stack<ChangeRecord> _change_history;
+    // largest number of records _change_history held, for memory_usage
+    std::size_t _change_log_peak;
+    my::ReorgCounters _last_counters;
+    my::ReorgCounters _total_counters;
+    my::LatencyHistogram _reorg_latency;
+    my::LatencyHistogram _query_latency;
+    std::uint64_t _last_reorg_ticks;
+    bool _track_latency;
+    std::unique_ptr<my::TraceWriter> _trace;
+    std::unique_ptr<my::PhaseTracer> _phases;
+    std::unique_ptr<my::SharedComponentsWriter> _publisher;
+    // vertices whose level was increased by the current deletion, collected only to publish the levels
+    std::vector<Vertex> _bumped;
+    // deletions since construction, published with the segment
+    std::uint64_t _deletions;
+    // set during would_disconnect: every change is recorded, and a split only rewinds the records of the current deletion,
+    // which start at _speculation_mark
+    bool _speculating;
+    std::size_t _speculation_mark;
+    // number of DynGraphFork sharing the state, and the one whose state and deleted edges are in place of the own ones
+    std::size_t _live_forks;
+    DynGraphFork *_installed_fork;
+    // set while an AsyncDynGraph answers queries from _components on other threads, nothing may replace the array then
+    bool _async_attached;
+
+    // EdgeSlot locates both halves of an edge in the out-edge lists of the graph, at its smaller and its larger endpoint,
+    // which is everything needed to erase it without a scan
+    struct EdgeSlot
+    {
+        OutEdgeList::iterator at_lo;
+        OutEdgeList::iterator at_hi;
+    };
+    // endpoint index, a multimap since the graph may have parallel edges
+    std::unordered_multimap<std::uint64_t, EdgeSlot> _edge_index;
+    bool _edge_index_built;
+
+    // MaskedEdge holds an edge taken out of the graph by _mask_edge: the nodes of its two halves and of the global edge
+    // list, each with the node that followed it, so that _unmask_edge splices them back where they were
+    struct MaskedEdge
+    {
+        Vertex lo;
+        Vertex hi;
+        OutEdgeList half_lo;
+        OutEdgeList half_hi;
+        StoredEdgeList stored;
+        OutEdgeList::iterator next_lo;
+        OutEdgeList::iterator next_hi;
+        StoredEdgeList::iterator next_stored;
+    };
+
+    // compaction policy and state, _compact_cursor is the next vertex to visit
+    double _compact_min_load_factor;
+    std::size_t _compact_per_deletion;
+    std::size_t _compact_trim_bytes;
+    std::size_t _compact_cursor;
+    // deletions since the current pass started (or the last one ended) and during the last full pass, bytes released during
+    // the current pass
+    std::size_t _compact_dirty;
+    std::size_t _compact_pass_deletions;
+    std::size_t _compact_sweep_bytes;
+    // a full pass released enough for malloc_trim, which is left to the next compact_edge_sets
+    bool _trim_pending;
+    my::CompactionStats _compaction_stats;
+
+    // sum of all levels, kept up to date with the level increases that are not rewound
+    long long _level_sum;
+    long long _init_level_sum;
+    std::size_t _deletions_since_init;
+    double _reroot_drift_factor;
+    std::size_t _reroot_min_deletions;
+    RootStrategy _reroot_strategy;
+    bool _reroot_background;
+
+    // background rebuild state. The shadow structure is only touched by the rebuild thread until _rebuild_ready is set,
+    // _rebuild_pending is shared with it under _rebuild_mutex.
+    std::thread _rebuild_thread;
+    std::mutex _rebuild_mutex;
+    std::atomic<bool> _rebuild_ready;
+    std::vector<std::pair<Vertex, Vertex>> _rebuild_pending;
+    std::unique_ptr<Graph> _shadow_graph;
+    std::unique_ptr<DynGraph> _shadow;
+
+    DynGraph(Graph &G, Vertex r, RootStrategy strategy, const my::MemoryPolicy &memory);
 
-    void _rewind();
+    // _rewind undoes the recorded changes, down to the first mark records
+    void _rewind(std::size_t mark = 0);
+    // _advise_state passes an access hint for the per-vertex arrays to the kernel, see my::advise_region
+    void _advise_state(my::Access access);
+    // _publish_all writes the whole state to the published segment, if any
+    void _publish_all();
+    // _bumped_sink is where Process B lists the vertices it raises, null unless levels are published
+    std::vector<Vertex> *_bumped_sink();
+    // each engine runs both processes to completion and returns the size of the component that broke off, 0 if none did.
+    // level_bumps is set to the number of level increases that were kept.
+    std::size_t _reorg_state_machine(Vertex v, Vertex u, std::size_t &level_bumps);
+    std::size_t _reorg_coroutine(Vertex v, Vertex u, std::size_t &level_bumps);
+    bool _reroot_due();
+    void _rebuild(std::size_t n, std::vector<std::pair<Vertex, Vertex>> edge_list, RootStrategy strategy);
+    void _replay_into_shadow(const std::vector<std::pair<Vertex, Vertex>> &deletions);
+    // _swap_structure exchanges the ES tree and components of the two DynGraph, the graphs are not touched
+    void _swap_structure(DynGraph &other);
+    std::uint64_t _edge_key(Vertex u, Vertex v);
+    // _unindex_removed drops the index entry of an edge between v and u that was removed from the graph without the index
+    void _unindex_removed(Vertex v, Vertex u);
+    // _split_component names the component detected by Process A and undoes the changes of Process B
+    void _split_component(const std::list<Vertex> &small_component);
+    // _compact visits the next vertices vertices for the compaction, and runs the pending malloc_trim if trim is set
+    std::size_t _compact(std::size_t vertices, bool trim);
+    // _reorg_after_remove is reorg_after_remove without the upkeep of the endpoint index
+    void _reorg_after_remove(Vertex v, Vertex u);
+    // _mask_edge takes e out of the graph without destroying it, _unmask_edge puts it back. Edges are put back in the
+    // reverse order they were taken out in.
+    void _mask_edge(Edge e, MaskedEdge &masked);
+    void _unmask_edge(MaskedEdge &masked);
+    // _speculate runs the deletion of the masked edge between v and u, recording every change
+    void _speculate(Vertex v, Vertex u);
+    // _history_vertices appends the vertex of every record in _change_history, from the top, and leaves it as it was
+    void _history_vertices(std::vector<Vertex> &vertices);
+    // _reorg returns the size of the component that broke off, 0 if none did
+    std::size_t _reorg(Vertex v, Vertex u);
 };
 
 #endif
@@ -0,0 +1,82 @@
+#ifndef DYN_GRAPH_FORK_HPP
+#define DYN_GRAPH_FORK_HPP
+
+#include "graph.hpp"
+#include "edge_set.hpp"
+#include "dyn_graph.hpp"
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// DynGraphFork is an independent branch of the connectivity state of a DynGraph, made with DynGraph::fork. It shares the
+// graph and the per-vertex state of that DynGraph and only holds what differs: the edges deleted in the branch and a copy
+// of the state of every vertex a deletion of the branch has touched, made when it is first touched. Forking costs O(1) from
+// a DynGraph and O(touched vertices) from another fork, instead of a copy of the graph and of the whole ES structure.
+//
+// A deletion runs on the arrays of the DynGraph: the first one puts the state of the fork in their place, keeping theirs,
+// and takes the deleted edges out of the graph, and both stay so for the next deletions of the same fork. Each deletion
+// runs like DynGraph::would_disconnect, the state of the vertices it changed is kept and the rest is rewound, so it costs
+// the deletion plus a copy of what it touched. Switching to another fork, or using the DynGraph, puts its state and the
+// edges back first, which costs O(touched vertices + deleted edges) of the fork that was in place; so does destroying it.
+// Queries cost an array read on the fork in place and a hash lookup on the others.
+//
+// Until then the graph lacks the edges the fork deleted, so direct reads of the graph have to call DynGraph::reclaim_state
+// first. The DynGraph must not be changed while forks of it exist (asserted on its deletions and init), and all forks of
+// one DynGraph must be used from one thread at a time, since their deletions run on its arrays.
+class DynGraphFork
+{
+public:
+    explicit DynGraphFork(DynGraph &base);
+    DynGraphFork(const DynGraphFork &other);
+    DynGraphFork(DynGraphFork &&other);
+    DynGraphFork &operator=(const DynGraphFork &) = delete;
+    ~DynGraphFork();
+
+    // fork returns a branch of this fork, which starts from its current state
+    DynGraphFork fork();
+    // e is an edge of the graph of the DynGraph that has not been deleted in this fork
+    void dyn_remove_edge(Edge e);
+    // dyn_remove_edge deletes an edge between u and v, returns false if the fork has none
+    bool dyn_remove_edge(Vertex u, Vertex v);
+    bool query_is_connected(Vertex u, Vertex v);
+    int level(Vertex v);
+    int component(Vertex v);
+    // touched_vertices is the number of vertices whose state the fork holds, deleted_edges the number of edges it deleted
+    std::size_t touched_vertices();
+    std::size_t deleted_edges();
+
+private:
+    friend class DynGraph;
+
+    // VertexState is the state of one vertex as seen by the fork
+    struct VertexState
+    {
+        int level;
+        int component;
+        EdgeSet alpha;
+        EdgeSet beta;
+        EdgeSet gamma;
+    };
+
+    DynGraph &_base;
+    // the state of the fork for the vertices it touched, or the one of the DynGraph while the fork is in place
+    std::unordered_map<Vertex, VertexState> _touched;
+    // deleted edges in the order of the deletions, and their properties, which identify them
+    std::vector<Edge> _deleted;
+    std::unordered_set<const void *> _deleted_properties;
+    int _component_max_idx;
+    // the deleted edges taken out of the graph while the fork is in place, in a deque since they hold list nodes and must
+    // not be moved
+    std::deque<DynGraph::MaskedEdge> _masked;
+
+    // _install puts the fork in place of the DynGraph, and of any other fork there, _uninstall puts the DynGraph back
+    void _install();
+    void _uninstall();
+    // _swap_state exchanges the state of the touched vertices with the one in the arrays of the DynGraph
+    void _swap_state();
+    // _state returns the state of v as seen by the fork, or null if it is the one in the arrays of the DynGraph
+    const VertexState *_state(Vertex v);
+};
+
+#endif
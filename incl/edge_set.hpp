@@ -2,6 +2,10 @@
 #define EDGE_SET_HPP
 
 #include "graph.hpp"
+#include "state_allocator.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <boost/functional/hash.hpp>
@@ -18,29 +22,141 @@ struct vertex_pair_hash
     }
 };
 
-typedef std::unordered_set<std::pair<Vertex, Vertex>, vertex_pair_hash>::iterator EdgeSetIterator;
+typedef std::unordered_set<std::pair<Vertex, Vertex>, vertex_pair_hash, std::equal_to<std::pair<Vertex, Vertex>>,
+                           my::ArenaAllocator<std::pair<Vertex, Vertex>>>
+    EdgeHashSet;
 
+// EdgeSetIterator walks either representation of an EdgeSet. It stays valid until the set it came from is modified, moved
+// or cleared; changing other sets does not affect it.
+class EdgeSetIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::pair<Vertex, Vertex> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::pair<Vertex, Vertex> *pointer;
+    typedef const std::pair<Vertex, Vertex> &reference;
+
+    EdgeSetIterator() : _at(nullptr), _hashed(false)
+    {
+    }
+
+    reference operator*() const
+    {
+        return _hashed ? *_it : *_at;
+    }
+
+    pointer operator->() const
+    {
+        return &**this;
+    }
+
+    EdgeSetIterator &operator++()
+    {
+        if (_hashed)
+        {
+            ++_it;
+        }
+        else
+        {
+            ++_at;
+        }
+        return *this;
+    }
+
+    bool operator==(const EdgeSetIterator &other) const
+    {
+        return _hashed ? _it == other._it : _at == other._at;
+    }
+
+    bool operator!=(const EdgeSetIterator &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    friend class EdgeSet;
+
+    explicit EdgeSetIterator(const std::pair<Vertex, Vertex> *at) : _at(at), _hashed(false)
+    {
+    }
+
+    explicit EdgeSetIterator(EdgeHashSet::const_iterator it) : _at(nullptr), _it(it), _hashed(true)
+    {
+    }
+
+    const std::pair<Vertex, Vertex> *_at;
+    EdgeHashSet::const_iterator _it;
+    bool _hashed;
+};
+
+// EdgeSet holds up to INLINE_CAPACITY edges inside the object and scans them linearly, so the many vertices with a few edges
+// in alpha, beta or gamma use no heap at all. Adding one more edge moves them to a hash table, which is released again once
+// removals bring the set down to SHRINK_SIZE edges; the gap between the two keeps a set at the boundary from converting on
+// every change. A moved-from set is empty, which _rewind and the avalanche steps rely on.
+//
+// The table, its buckets and its nodes come from the RegionArena named by set_arena, or from the heap by default.
 class EdgeSet
 {
 public:
-    EdgeSet() = default;
+    static constexpr int INLINE_CAPACITY = 3;
+    static constexpr int SHRINK_SIZE = 1;
 
+    EdgeSet() : _size(0), _arena(0)
+    {
+    }
+
+    // a set moved into keeps its arena, its table keeps the one it was made in
     EdgeSet &operator=(EdgeSet &&other);
     EdgeSet(EdgeSet &&other);
+    // copy returns a deep copy of the set, there is no copy constructor so that sets are never copied by accident
+    EdgeSet copy() const;
+    // set_arena makes the tables of the set from now on in region_arena(arena), 0 for the heap
+    void set_arena(std::uint32_t arena);
 
     void add_edge(Vertex u, Vertex v);
     bool remove_edge(Vertex u, Vertex v);
     bool contains(Vertex u, Vertex v);
-    bool empty();
+    bool empty()
+    {
+        return _table ? _table->empty() : _size == 0;
+    }
+    std::size_t size();
+    // is_hashed tells whether the edges are in the hash table rather than inline
+    bool is_hashed();
     void clear();
+    // shrink releases the memory the set no longer needs: a table holding at most INLINE_CAPACITY edges goes back inline, a
+    // table whose load factor fell below min_load_factor gets the smallest bucket array for its size. Invalidates iterators.
+    // Returns the number of heap bytes released (see memory_usage).
+    std::size_t shrink(float min_load_factor);
     Vertex other_end(EdgeSetIterator it, Vertex v);
     EdgeSetIterator begin();
     EdgeSetIterator end();
     void print();
+    // memory_usage returns the heap bytes of the hash table, buckets and nodes, not counting sizeof(EdgeSet).
+    // An inline set uses none.
+    std::size_t memory_usage();
 
 
 private:
-    std::unordered_set<std::pair<Vertex, Vertex>, vertex_pair_hash> _internal_set;
+    // TableDeleter gives a table back to the allocator it was made with
+    struct TableDeleter
+    {
+        void operator()(EdgeHashSet *table) const;
+    };
+
+    // number of inline edges, 0 while the hash table is in use
+    std::uint32_t _size;
+    // id of the arena of new tables, in the padding after _size
+    std::uint32_t _arena;
+    std::pair<Vertex, Vertex> _inline[INLINE_CAPACITY];
+    std::unique_ptr<EdgeHashSet, TableDeleter> _table;
+
+    // _make_table builds a table in the arena of the set from the arguments of an EdgeHashSet constructor, last the allocator
+    template <class... Args>
+    EdgeHashSet *_make_table(Args &&...args) const;
+    void _to_table();
+    void _to_inline();
 };
 
-#endif
\ No newline at end of file
+#endif
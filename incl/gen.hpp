@@ -1,4 +1,6 @@
 #include "graph.hpp"
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <boost/random/mersenne_twister.hpp>
 
@@ -8,4 +10,27 @@ namespace gen
     void generate_random(Graph &G, int n, int m, std::vector<Edge> &edge_handles, boost::mt19937 &mt);
     void generate_line(Graph &G, int n, std::vector<Edge> &edge_handles);
     void generate_fully_connected(Graph &G, int n, std::vector<Edge> &edge_handles);
+
+    // The generators below draw their edges in parallel, in fixed chunks seeded from seed and the chunk index, so the graph
+    // only depends on the seed and not on the number of threads (0: one per core). Self loops and parallel edges are dropped,
+    // the edges are sorted and the graph, which has to be empty, is built in one pass from the edge list.
+
+    // generate_rmat draws m edges of the recursive matrix model on 2^scale vertices: every edge descends scale levels of the
+    // adjacency matrix, picking a quadrant with probabilities a, b, c and 1 - a - b - c. The defaults are the Graph500 ones,
+    // giving a skewed degree distribution with a few hubs.
+    void generate_rmat(Graph &G, int scale, long m, std::vector<Edge> &edge_handles, std::uint64_t seed,
+                       double a = 0.57, double b = 0.19, double c = 0.19, int threads = 0);
+    // grids connect every vertex to its neighbours along each axis, the vertex (x, y, z) is x + nx * (y + ny * z)
+    void generate_grid_2d(Graph &G, long nx, long ny, std::vector<Edge> &edge_handles);
+    void generate_grid_3d(Graph &G, long nx, long ny, long nz, std::vector<Edge> &edge_handles);
+    // generate_barabasi_albert attaches every new vertex to k earlier ones chosen proportionally to their degree
+    // (Batagelj-Brandes). The attachment is sequential by nature, only the graph construction is shared with the others.
+    void generate_barabasi_albert(Graph &G, long n, int k, std::vector<Edge> &edge_handles, std::uint64_t seed);
+    // generate_sbm splits n vertices into equal blocks and adds every pair inside a block with probability p_in, every pair
+    // across blocks with probability p_out. Pairs are skipped geometrically, so the time is proportional to the edges drawn.
+    void generate_sbm(Graph &G, long n, int blocks, double p_in, double p_out, std::vector<Edge> &edge_handles,
+                      std::uint64_t seed, int threads = 0);
+
+    // deletion_sequence returns the endpoints of every edge of G in random order
+    std::vector<std::pair<Vertex, Vertex>> deletion_sequence(const Graph &G, boost::mt19937 &mt);
 }
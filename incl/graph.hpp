@@ -2,7 +2,9 @@
 #define GRAPH_HPP
 
 #include <boost/graph/adjacency_list.hpp>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 /* Graph (https://www.boost.org/doc/libs/1_61_0/libs/graph/doc/graph_concepts.html) */
@@ -19,4 +21,9 @@ typedef boost::graph_traits<Graph>::edge_iterator EdgeIterator;
 typedef boost::graph_traits<Graph>::out_edge_iterator OutEdgeIterator;
 typedef boost::graph_traits<Graph>::in_edge_iterator InEdgeIterator;
 
+/* Out-edge list of a vertex as stored inside the graph (Graph::out_edge_list), for code that edits the storage directly */
+typedef std::remove_reference<decltype(std::declval<Graph &>().out_edge_list(0))>::type OutEdgeList;
+/* Global list of the edges inside the graph (Graph::m_edges), which the out-edge lists point into */
+typedef decltype(Graph::m_edges) StoredEdgeList;
+
 #endif
\ No newline at end of file
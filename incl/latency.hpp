@@ -0,0 +1,53 @@
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace my
+{
+    // clock_ticks reads the time stamp counter on x86, a steady clock in nanoseconds elsewhere. Only differences of two
+    // readings on the same thread are meaningful, convert them with ticks_to_ns.
+    std::uint64_t clock_ticks();
+    // ticks_per_ns is measured against the steady clock on the first call, which takes a few milliseconds
+    double ticks_per_ns();
+    double ticks_to_ns(double ticks);
+    double ticks_to_ms(double ticks);
+
+    // LatencyHistogram counts durations in log-linear buckets, like an HDR histogram: values below 2 * SUB_BUCKETS ticks
+    // get a bucket each, larger ones are grouped by their highest bit into SUB_BUCKETS linear buckets. The relative error of a
+    // percentile is below 1 / SUB_BUCKETS, recording is a few instructions and the memory use is fixed.
+    // A histogram is not synchronized, it is read (copied) by the thread recording into it.
+    class LatencyHistogram
+    {
+    public:
+        static const int SUB_BUCKETS = 16;
+        static const int NUM_BUCKETS = 2 * SUB_BUCKETS + 59 * SUB_BUCKETS;
+
+        LatencyHistogram();
+
+        void record(std::uint64_t ticks);
+        void reset();
+        LatencyHistogram &operator+=(const LatencyHistogram &other);
+
+        std::uint64_t count() const;
+        std::uint64_t min() const;
+        std::uint64_t max() const;
+        double mean() const;
+        // percentile returns the largest value of the bucket holding the p-th percentile (p in [0, 100]), in ticks
+        std::uint64_t percentile(double p) const;
+
+    private:
+        std::vector<std::uint64_t> _counts;
+        std::uint64_t _count;
+        std::uint64_t _min;
+        std::uint64_t _max;
+        // sum of all values, in ticks, for the mean
+        double _sum;
+
+        static int _bucket(std::uint64_t ticks);
+        static std::uint64_t _bucket_upper(int bucket);
+    };
+}
+
+#endif
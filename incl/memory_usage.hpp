@@ -0,0 +1,44 @@
+#ifndef MEMORY_USAGE_HPP
+#define MEMORY_USAGE_HPP
+
+#include <cstddef>
+
+namespace my
+{
+    // MemoryUsage is the heap footprint of a DynGraph in bytes, broken down by structure. Node based containers are counted
+    // with the size the allocator hands out for every node (see allocation_bytes), so the numbers are estimates close to
+    // what the process actually uses, not only the payload.
+    struct MemoryUsage
+    {
+        // adjacency lists, vertex vector and edge list of the boost graph
+        std::size_t graph;
+        std::size_t levels;
+        std::size_t components;
+        // vector of EdgeSet plus every hash table: buckets and nodes
+        std::size_t alpha;
+        std::size_t beta;
+        std::size_t gamma;
+        // largest change log held during a single deletion, since construction
+        std::size_t change_log_peak;
+        // endpoint index of dyn_remove_edge(u, v), 0 until it is built
+        std::size_t edge_index;
+
+        std::size_t total() const;
+    };
+
+    // CompactionStats counts the work of the edge set compaction of a DynGraph, see DynGraph::set_compaction_policy
+    struct CompactionStats
+    {
+        // full passes over the vertices, sets given back memory, the bytes they released and the calls to malloc_trim
+        std::size_t sweeps;
+        std::size_t sets_shrunk;
+        std::size_t bytes_released;
+        std::size_t trims;
+    };
+
+    // allocation_bytes returns the size of the heap chunk glibc malloc uses for a request of the given size:
+    // an 8 byte header, rounded up to 16 bytes, at least 32
+    std::size_t allocation_bytes(std::size_t request);
+}
+
+#endif
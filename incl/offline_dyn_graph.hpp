@@ -0,0 +1,52 @@
+#ifndef OFFLINE_DYN_GRAPH_HPP
+#define OFFLINE_DYN_GRAPH_HPP
+
+#include "graph.hpp"
+#include <utility>
+#include <vector>
+
+// OfflineDynGraph answers the same queries as DynGraph when the whole deletion sequence is known upfront. The deletions are
+// processed in reverse, as insertions into a union-find with union by rank and without path compression, and every link
+// remembers the last step its edge is present. Two vertices are connected after s deletions iff they reach the same vertex
+// following only links present at step s, which is at most O(log n) links since ranks bound the tree height.
+// Building takes O((n + m) log n), every query O(log n), independent of the order of the deletions.
+//
+// The deletions are replayed one at a time with reorg_after_remove or dyn_remove_edge, like with DynGraph, and
+// query_is_connected answers for the current step. query_is_connected_at answers for any step.
+class OfflineDynGraph
+{
+public:
+    // deletions holds the endpoints of the edges in the order they will be deleted, every one an edge of G at the time
+    OfflineDynGraph(Graph &G, const std::vector<std::pair<Vertex, Vertex>> &deletions);
+
+    // dyn_remove_edge removes e from the graph and moves to the next step, e must be the next deletion
+    void dyn_remove_edge(Edge e);
+    // reorg_after_remove moves to the next step after (v, u) has been removed from the graph, (v, u) must be the next deletion
+    void reorg_after_remove(Vertex v, Vertex u);
+    bool query_is_connected(Vertex v, Vertex u);
+    bool query_is_connected(Edge e);
+
+    // query_is_connected_at answers for the graph after the first step deletions, step in [0, num_steps()]
+    bool query_is_connected_at(std::size_t step, Vertex v, Vertex u);
+    // deletion_breaks is true if the step-th deletion disconnects its endpoints
+    bool deletion_breaks(std::size_t step);
+
+    std::size_t current_step();
+    std::size_t num_steps();
+
+private:
+    Graph &_G;
+    std::vector<std::pair<Vertex, Vertex>> _deletions;
+    std::size_t _step;
+
+    std::vector<Vertex> _parent;
+    std::vector<int> _rank;
+    // _link_step[x] is the last step the link from x to its parent is present
+    std::vector<std::size_t> _link_step;
+
+    void _link(Vertex a, Vertex b, std::size_t step);
+    // _find_at returns the representative of x among the links present at step
+    Vertex _find_at(Vertex x, std::size_t step);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PHASE_TRACE_HPP
+#define PHASE_TRACE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace my
+{
+    // PhaseArg is a named integer shown with an event, like the size of a component or the number of records rewound
+    struct PhaseArg
+    {
+        const char *name;
+        long long value;
+    };
+
+    // PhaseTracer collects timed phases in memory and writes them in the Chrome trace event format (complete "X" events),
+    // which chrome://tracing and ui.perfetto.dev open directly. Every track is shown as a thread of its own, so the turns
+    // of Process A and Process B appear as two rows below the deletion they belong to.
+    // Recording an event is a push_back. Event names and argument names must be string literals, only the pointers are kept.
+    // The events are written when the tracer is closed or destroyed.
+    class PhaseTracer
+    {
+    public:
+        enum Track
+        {
+            Deletions = 1,
+            ProcessA = 2,
+            ProcessB = 3,
+        };
+
+        // opens path for writing, check is_open for failure. Events past max_events are counted as dropped, not stored.
+        PhaseTracer(const std::string &path, std::size_t max_events = 1 << 20);
+        ~PhaseTracer();
+        bool is_open();
+
+        // complete records a phase that ran from start to end, both in clock_ticks
+        void complete(const char *name, Track track, std::uint64_t start, std::uint64_t end,
+                      std::initializer_list<PhaseArg> args = {});
+        std::size_t size();
+        std::size_t dropped();
+        // close writes the events and closes the file, returns false if writing failed. Later calls do nothing.
+        bool close();
+
+    private:
+        static constexpr int MAX_ARGS = 4;
+
+        struct Event
+        {
+            const char *name;
+            Track track;
+            std::uint64_t start;
+            std::uint64_t end;
+            int num_args;
+            PhaseArg args[MAX_ARGS];
+        };
+
+        std::ofstream _out;
+        std::vector<Event> _events;
+        std::size_t _max_events;
+        std::size_t _dropped;
+        // timestamps are written relative to the tracer creation
+        std::uint64_t _origin;
+    };
+}
+
+#endif
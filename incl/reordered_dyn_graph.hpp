@@ -0,0 +1,61 @@
+#ifndef REORDERED_DYN_GRAPH_HPP
+#define REORDERED_DYN_GRAPH_HPP
+
+#include "graph.hpp"
+#include "dyn_graph.hpp"
+#include <memory>
+#include <vector>
+
+// VertexOrder selects how ReorderedDynGraph numbers the vertices, so that vertices visited one after the other by BFS, DFS
+// and the avalanche of Process B sit close together in _levels, _components, alpha, beta and gamma
+enum class VertexOrder
+{
+    Identity, // keep the ids
+    Bfs,      // BFS order, component by component, from the highest degree vertex of each
+    // BFS visiting the neighbours by increasing degree from a pseudo-peripheral vertex, reversed. The endpoints of every
+    // edge get close ids, the bandwidth of the adjacency matrix is small.
+    ReverseCuthillMcKee,
+    Degree, // decreasing degree, the hubs and their state share a few cache lines
+};
+
+namespace my
+{
+    // vertex_order returns the new id of every vertex, a permutation of [0, n)
+    std::vector<Vertex> vertex_order(const Graph &G, VertexOrder order);
+    // relabel_graph fills the empty graph H with the edges of G under the permutation new_id, added in increasing order of
+    // their new endpoints, so the adjacency lists are allocated in the new order too
+    void relabel_graph(const Graph &G, const std::vector<Vertex> &new_id, Graph &H);
+}
+
+// ReorderedDynGraph renumbers a graph once at load time and keeps a DynGraph over its own renumbered copy. Every call takes
+// and returns the original vertex ids, translated with two array lookups. The original graph is not used after construction
+// and can be released, deletions are made by endpoints.
+class ReorderedDynGraph
+{
+public:
+    // root is an original id
+    ReorderedDynGraph(const Graph &G, VertexOrder order, Vertex root);
+    ReorderedDynGraph(const Graph &G, VertexOrder order, RootStrategy strategy = RootStrategy::Center);
+
+    // dyn_remove_edge deletes an edge between u and v, returns false if there is none (see DynGraph::dyn_remove_edge)
+    bool dyn_remove_edge(Vertex u, Vertex v);
+    bool query_is_connected(Vertex u, Vertex v);
+    Vertex get_root();
+
+    Vertex to_internal(Vertex v);
+    Vertex to_external(Vertex v);
+    // the renumbered graph and the structure built over it, in internal ids
+    const Graph &graph();
+    DynGraph &dyn_graph();
+
+private:
+    // _new_id[original] and _old_id[internal]
+    std::vector<Vertex> _new_id;
+    std::vector<Vertex> _old_id;
+    Graph _H;
+    std::unique_ptr<DynGraph> _DG;
+
+    void _relabel(const Graph &G, VertexOrder order);
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <cstddef>
+
+namespace my
+{
+    enum class SchedulePolicy
+    {
+        Fixed,
+        Adaptive
+    };
+
+    // StepScheduler decides how many consecutive steps Process A and Process B get before control is handed to the other process,
+    // and how many steps each of the two DFS branches of Process A gets before switching branches.
+    // The default scheduler (quantum 1, ratio 1:1) is the strict alternation described in the paper.
+    //
+    // The worst-case guarantee is kept because every process is always given a share of at least 1 / (1 + max_ratio) of the
+    // steps, and a process can overshoot by at most one turn (quantum * max_ratio steps). The total work of a deletion is therefore
+    // within a constant factor of the work of whichever process finishes first, same as with strict alternation.
+    class StepScheduler
+    {
+    public:
+        // strict alternation, one step each
+        StepScheduler();
+        // quantum: steps per turn, ratio_a : ratio_b: relative number of turns given to A and B.
+        // With the adaptive policy the ratios are only the starting point and move within [1, max_ratio].
+        StepScheduler(int quantum, int ratio_a, int ratio_b, SchedulePolicy policy = SchedulePolicy::Fixed, int max_ratio = 8);
+
+        // steps Process A gets before switching to Process B
+        int steps_a() const;
+        // steps Process B gets before switching to Process A
+        int steps_b() const;
+        // steps each DFS branch of Process A gets before switching to the other branch
+        int branch_quantum() const;
+
+        // record feeds the outcome of a finished deletion to the adaptive policy. a_won is true when Process A detected a break
+        // before Process B finished, small_size is the size of the component that broke off (0 if none).
+        void record(bool a_won, std::size_t small_size);
+
+        // exponential moving averages kept by the adaptive policy
+        double a_win_rate() const;
+        double avg_small_size() const;
+        // restore_averages puts back averages saved from another scheduler with the same settings, to continue where it left off
+        void restore_averages(double a_win_rate, double avg_small_size);
+
+        // the settings, with the current ratios of the adaptive policy
+        int quantum() const;
+        int ratio_a() const;
+        int ratio_b() const;
+        int max_ratio() const;
+        SchedulePolicy policy() const;
+
+    private:
+        int _quantum;
+        int _ratio_a;
+        int _ratio_b;
+        int _max_ratio;
+        SchedulePolicy _policy;
+
+        double _a_win_ema;
+        double _small_size_ema;
+
+        void _adapt();
+    };
+}
+
+#endif
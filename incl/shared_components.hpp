@@ -0,0 +1,100 @@
+#ifndef SHARED_COMPONENTS_HPP
+#define SHARED_COMPONENTS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace my
+{
+    // A shared components segment is a POSIX shared memory object (shm_open) holding the component of every vertex, and
+    // optionally its level, as published by one writer process. Any number of reader processes map it and answer
+    // connectivity queries without talking to the writer.
+    //
+    // Layout: a SharedComponentsHeader, padded to 64 bytes, then num_vertices components (int32), then num_vertices levels
+    // (int32) if has_levels. Updates are made under a sequence lock: the writer makes seq odd, writes, and makes it even
+    // again; a reader retries whenever seq was odd or changed while it read. A writer that dies during an update leaves seq
+    // odd for good, so readers check whether writer_pid is still alive when an update takes long.
+    const std::uint64_t SHARED_COMPONENTS_MAGIC = 0x45534353484d3031ULL;
+    const std::uint32_t SHARED_COMPONENTS_VERSION = 2;
+
+    struct SharedComponentsHeader
+    {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t has_levels;
+        std::uint64_t num_vertices;
+        std::atomic<std::uint64_t> seq;
+        // deletions applied by the writer, the published state is current as of this one
+        std::atomic<std::uint64_t> deletions;
+        std::int32_t writer_pid;
+    };
+
+    // SharedComponentsWriter creates and updates a segment. It owns the name: the segment is removed when the writer is
+    // closed or destroyed, readers that mapped it keep their mapping.
+    class SharedComponentsWriter
+    {
+    public:
+        SharedComponentsWriter();
+        ~SharedComponentsWriter();
+
+        // create makes a segment called name ("/something"), replacing a stale one, returns false with a message in error
+        bool create(const std::string &name, std::size_t num_vertices, bool with_levels, std::string &error);
+        bool has_levels();
+        // an update is begin, any number of set_component and set_level, then end. Readers see all of it or none of it.
+        void begin();
+        void set_component(std::size_t v, int component);
+        void set_level(std::size_t v, int level);
+        void end();
+        // publish_all writes every entry in one update, levels may be null when the segment has none
+        void publish_all(const int *components, const int *levels);
+        void set_deletions(std::uint64_t deletions);
+        void close();
+
+    private:
+        std::string _name;
+        void *_base;
+        std::size_t _length;
+        SharedComponentsHeader *_header;
+        int *_components;
+        int *_levels;
+    };
+
+    // SharedComponentsReader maps a segment read only. It does not depend on the graph library, so worker processes only
+    // need this class and shared_components.cpp.
+    class SharedComponentsReader
+    {
+    public:
+        SharedComponentsReader();
+        ~SharedComponentsReader();
+
+        // open maps the segment called name, returns false with a message in error if it is missing or not a segment
+        bool open(const std::string &name, std::string &error);
+        std::size_t num_vertices();
+        bool has_levels();
+        // query_is_connected sets connected from one consistent state, waiting while the writer is in the middle of an
+        // update. A writer that died during an update leaves the segment half written for good: once its process is gone,
+        // the call returns false instead of waiting forever, and so does every later one. A new writer creates a new
+        // segment under the name, which the reader has to open again.
+        bool query_is_connected(std::size_t u, std::size_t v, bool &connected);
+        // component and level are read the same way and return -1 when the writer died during an update, level also when
+        // the segment has no levels
+        int component(std::size_t v);
+        int level(std::size_t v);
+        std::uint64_t deletions();
+        void close();
+
+    private:
+        void *_base;
+        std::size_t _length;
+        const SharedComponentsHeader *_header;
+        const int *_components;
+        const int *_levels;
+
+        // _read_pair loads a[x] and a[y] from one consistent state, returns false if the writer died during an update
+        bool _read_pair(const int *a, std::size_t x, std::size_t y, int &ax, int &ay);
+    };
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SPANNING_FOREST_HPP
+#define SPANNING_FOREST_HPP
+
+#include "graph.hpp"
+#include "edge_set.hpp"
+#include "state_allocator.hpp"
+#include <iterator>
+#include <utility>
+
+namespace my
+{
+    // tree_parent returns the parent of v in the BFS tree kept by the ES structure: the other end of the first edge of
+    // alpha(v), one level closer to the root. alpha(v) must not be empty.
+    Vertex tree_parent(my::StateVector<EdgeSet> &alpha, Vertex v);
+}
+
+// SpanningForestIterator walks the edges (v, parent of v) of every vertex v that has a parent, by increasing v. Every
+// component has exactly one vertex without a parent, its vertex of smallest level, so the edges form a spanning tree of
+// every component. The iterator stays valid until the next deletion.
+class SpanningForestIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::pair<Vertex, Vertex> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::pair<Vertex, Vertex> *pointer;
+    typedef const std::pair<Vertex, Vertex> &reference;
+
+    SpanningForestIterator() : _alpha(nullptr), _v(0)
+    {
+    }
+
+    // the iterator starts at the first vertex from v on that has a parent
+    SpanningForestIterator(my::StateVector<EdgeSet> &alpha, Vertex v);
+
+    reference operator*() const
+    {
+        return _edge;
+    }
+
+    pointer operator->() const
+    {
+        return &_edge;
+    }
+
+    SpanningForestIterator &operator++();
+
+    bool operator==(const SpanningForestIterator &other) const
+    {
+        return _v == other._v;
+    }
+
+    bool operator!=(const SpanningForestIterator &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    my::StateVector<EdgeSet> *_alpha;
+    Vertex _v;
+    std::pair<Vertex, Vertex> _edge;
+
+    // _skip moves to the first vertex from _v on that has a parent
+    void _skip();
+};
+
+// SpanningForest is the range of the edges of the spanning forest, see DynGraph::spanning_forest
+class SpanningForest
+{
+public:
+    explicit SpanningForest(my::StateVector<EdgeSet> &alpha) : _alpha(alpha)
+    {
+    }
+
+    SpanningForestIterator begin();
+    SpanningForestIterator end();
+
+private:
+    my::StateVector<EdgeSet> &_alpha;
+};
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef STATE_ALLOCATOR_HPP
+#define STATE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace my
+{
+    // PagePolicy selects the page size backing the per-vertex arrays of a DynGraph
+    enum class PagePolicy
+    {
+        Default,     // the heap, 4K pages unless the kernel collapses them on its own
+        Transparent, // 2M aligned mappings advised with MADV_HUGEPAGE, the kernel backs them with huge pages when it can
+        Explicit,    // MAP_HUGETLB from the reserved pool (vm.nr_hugepages), Transparent when the pool is too small
+    };
+
+    // NumaPolicy selects where the pages of the per-vertex arrays are placed
+    enum class NumaPolicy
+    {
+        Default,    // first touch, on the node of the thread that initializes the array
+        Interleave, // round robin over all online nodes, random lookups spread over every memory controller
+        Bind,       // only on MemoryPolicy::node
+    };
+
+    struct MemoryPolicy
+    {
+        PagePolicy pages = PagePolicy::Default;
+        NumaPolicy numa = NumaPolicy::Default;
+        // node used by NumaPolicy::Bind
+        int node = 0;
+        // out-of-core mode: when set, regions are shared mappings of files created in this directory and unlinked at once.
+        // The kernel writes cold pages back to the files and drops them, so the arrays can outgrow RAM at the cost of page
+        // faults. Huge pages do not apply to file mappings, pages is ignored.
+        std::string directory;
+
+        bool operator==(const MemoryPolicy &other) const = default;
+    };
+
+    static const std::size_t HUGE_PAGE_SIZE = 2 << 20;
+    // allocations below this size stay on the heap whatever the policy, a mapping each would waste more than it saves
+    static const std::size_t MIN_REGION_SIZE = 1 << 16;
+
+    // Access describes the coming accesses to a region, see advise_region
+    enum class Access
+    {
+        Sequential, // read ahead aggressively, drop pages soon after they were used
+        Random,     // no read ahead, every fault reads a single page
+        WillNeed,   // start reading the range now
+    };
+
+    // RegionStats counts the mappings made by allocate_region
+    struct RegionStats
+    {
+        std::size_t regions; // regions currently mapped
+        std::size_t bytes;   // bytes currently mapped, after rounding to the page size
+        // since the start of the program: regions mapped from the explicit huge page pool, Explicit requests the pool could
+        // not serve, and NUMA policies the kernel refused (single node kernels, bad node)
+        std::size_t huge_tlb;
+        std::size_t explicit_fallbacks;
+        std::size_t numa_failures;
+        // files created for file backed regions, since the start of the program
+        std::size_t files;
+    };
+
+    // uses_region tells whether an allocation of bytes under policy is mapped with allocate_region or comes from the heap
+    bool uses_region(const MemoryPolicy &policy, std::size_t bytes);
+    // allocate_region maps bytes rounded up to the page size of the policy and applies the page and NUMA policy before the
+    // first touch. The page and NUMA requests are hints, a mapping is returned when only they fail. Throws std::bad_alloc,
+    // also when the file of a file backed region cannot be created or sized.
+    void *allocate_region(const MemoryPolicy &policy, std::size_t bytes);
+    // free_region unmaps a region, policy and bytes must be those it was allocated with
+    void free_region(void *p, const MemoryPolicy &policy, std::size_t bytes);
+    // advise_region passes an access hint for [p, p + bytes) to the kernel, widened to whole pages. Regions of file backed
+    // policies start out Sequential, since they are filled in order right after allocation.
+    void advise_region(const void *p, std::size_t bytes, Access access);
+    // state_allocation_bytes is the memory an allocation of bytes under policy takes, see allocation_bytes
+    std::size_t state_allocation_bytes(const MemoryPolicy &policy, std::size_t bytes);
+    RegionStats region_stats();
+    // numa_nodes returns the number of online NUMA nodes, 1 when the system does not tell
+    int numa_nodes();
+
+    // StateAllocator allocates the per-vertex arrays of DynGraph under a MemoryPolicy. It carries the policy, so containers
+    // assigned or swapped take the policy of the other one along with its memory.
+    template <class T>
+    class StateAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::false_type is_always_equal;
+
+        StateAllocator() noexcept
+        {
+        }
+
+        // the policy is shared between the copies, so copying an allocator cannot throw
+        StateAllocator(const MemoryPolicy &policy) : _policy(std::make_shared<const MemoryPolicy>(policy))
+        {
+        }
+
+        template <class U>
+        StateAllocator(const StateAllocator<U> &other) noexcept : _policy(other.shared_policy())
+        {
+        }
+
+        T *allocate(std::size_t n)
+        {
+            if (uses_region(policy(), n * sizeof(T)))
+            {
+                return static_cast<T *>(allocate_region(policy(), n * sizeof(T)));
+            }
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T *p, std::size_t n)
+        {
+            if (uses_region(policy(), n * sizeof(T)))
+            {
+                free_region(p, policy(), n * sizeof(T));
+                return;
+            }
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        const MemoryPolicy &policy() const
+        {
+            static const MemoryPolicy heap;
+            return _policy ? *_policy : heap;
+        }
+
+        const std::shared_ptr<const MemoryPolicy> &shared_policy() const
+        {
+            return _policy;
+        }
+
+        // memory of one is freed by the other when the policies agree, uses_region only depends on them
+        template <class U>
+        bool operator==(const StateAllocator<U> &other) const
+        {
+            return policy() == other.policy();
+        }
+
+    private:
+        // null for the default policy
+        std::shared_ptr<const MemoryPolicy> _policy;
+    };
+
+    template <class T>
+    using StateVector = std::vector<T, StateAllocator<T>>;
+
+    // RegionArena carves small blocks out of regions mapped under a policy, for the many allocations far below
+    // MIN_REGION_SIZE that would otherwise stay on the heap, like the hash tables of the edge sets of a DynGraph.
+    // Blocks are rounded up to a power of two and carved from CHUNK_SIZE regions, freed ones are kept on a list per size
+    // and reused; the regions are only unmapped with the arena. Blocks of CHUNK_SIZE or more get a region of their own.
+    // An arena is used by one thread at a time.
+    class RegionArena
+    {
+    public:
+        // a huge page, so that chunks fill whole pages under every policy
+        static const std::size_t CHUNK_SIZE = HUGE_PAGE_SIZE;
+
+        explicit RegionArena(const MemoryPolicy &policy);
+        RegionArena(const RegionArena &) = delete;
+        RegionArena &operator=(const RegionArena &) = delete;
+        ~RegionArena();
+
+        void *allocate(std::size_t bytes);
+        // deallocate takes back a block, bytes must be the size it was allocated with
+        void deallocate(void *p, std::size_t bytes);
+        // regions mapped for the chunks, and their bytes
+        std::size_t chunks();
+        std::size_t chunk_bytes();
+        // id names the arena for region_arena, so that 32 bits are enough to refer to it. It is 0 when MAX_ARENAS arenas
+        // exist already, the users of the arena then allocate on the heap.
+        std::uint32_t id();
+
+    private:
+        // size classes from 16 bytes to half a chunk
+        static const int MIN_CLASS = 4;
+        static const int CLASSES = 21 - MIN_CLASS;
+
+        MemoryPolicy _policy;
+        std::vector<void *> _chunks;
+        char *_next;
+        char *_end;
+        // heads of the free lists, the first word of a free block points to the next one
+        void *_free[CLASSES];
+        std::uint32_t _id;
+    };
+
+    // arenas that can be named at once, ids are reused once their arena is destroyed
+    static const std::uint32_t MAX_ARENAS = 4096;
+    // region_arena returns the arena named id, or null for 0. It may be called from any thread.
+    RegionArena *region_arena(std::uint32_t id);
+
+    // ArenaAllocator allocates from a RegionArena, or from the heap without one
+    template <class T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        ArenaAllocator() noexcept : _arena(nullptr)
+        {
+        }
+
+        explicit ArenaAllocator(RegionArena *arena) noexcept : _arena(arena)
+        {
+        }
+
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(other.arena())
+        {
+        }
+
+        T *allocate(std::size_t n)
+        {
+            if (_arena)
+            {
+                return static_cast<T *>(_arena->allocate(n * sizeof(T)));
+            }
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T *p, std::size_t n)
+        {
+            if (_arena)
+            {
+                _arena->deallocate(p, n * sizeof(T));
+                return;
+            }
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        RegionArena *arena() const
+        {
+            return _arena;
+        }
+
+        template <class U>
+        bool operator==(const ArenaAllocator<U> &other) const
+        {
+            return _arena == other.arena();
+        }
+
+    private:
+        RegionArena *_arena;
+    };
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "graph.hpp"
+#include "scheduler.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+    // A workload trace holds everything needed to repeat a run of DynGraph exactly: the graph in edge insertion order (which
+    // fixes the order DFS and BFS visit neighbours), the root, the engine, the settings that change the work of a deletion, and
+    // every deletion with its outcome.
+    //
+    // Binary layout, integers as unsigned LEB128 varints unless noted, doubles and the fingerprint as 8 bytes little endian:
+    //   "ESWL", version, engine, vertex count, edge count, edges as (u, v), fingerprint, root,
+    //   scheduler: quantum, ratio a, ratio b, policy, max ratio, a win rate (double), average small size (double),
+    //   reroot policy: drift factor (double), min deletions, strategy,
+    //   compaction policy: min load factor (double), vertices per deletion, cursor,
+    //   then one record per deletion until the end of the file: v, (u << 1) | breaks
+    // The deletion records are appended as they happen, a trace of a process that died is readable up to its last flushed record.
+    const std::uint64_t TRACE_VERSION = 2;
+
+    // TraceSettings are the settings of DynGraph that change the work of a deletion, as they were when the trace started.
+    // The scheduler keeps its current ratios and moving averages, reroot_strategy is a RootStrategy other than Random.
+    struct TraceSettings
+    {
+        StepScheduler scheduler;
+        double reroot_drift_factor;
+        std::uint64_t reroot_min_deletions;
+        std::uint64_t reroot_strategy;
+        double compact_min_load_factor;
+        std::uint64_t compact_per_deletion;
+        std::uint64_t compact_cursor;
+    };
+
+    struct TraceDeletion
+    {
+        Vertex v;
+        Vertex u;
+        // the deletion disconnected v and u
+        bool breaks;
+    };
+
+    struct WorkloadTrace
+    {
+        std::uint64_t engine;
+        std::uint64_t num_vertices;
+        std::vector<std::pair<Vertex, Vertex>> edges;
+        std::uint64_t fingerprint;
+        Vertex root;
+        TraceSettings settings;
+        std::vector<TraceDeletion> deletions;
+    };
+
+    // graph_fingerprint hashes the vertex count and the edges in iteration order
+    std::uint64_t graph_fingerprint(const Graph &G);
+
+    class TraceWriter
+    {
+    public:
+        // opens path and writes the header for the current state of G, check is_open for failure
+        TraceWriter(const std::string &path, const Graph &G, Vertex root, std::uint64_t engine, const TraceSettings &settings);
+        bool is_open();
+        void record_deletion(Vertex v, Vertex u, bool breaks);
+        void flush();
+
+    private:
+        std::ofstream _out;
+
+        void _write_varint(std::uint64_t x);
+        void _write_fixed64(std::uint64_t x);
+        void _write_double(double x);
+    };
+
+    // read_trace reads a whole trace, returns false with a message in error if the file is missing or malformed, or names an
+    // engine or a setting this build does not know.
+    // A truncated last deletion record is dropped.
+    bool read_trace(const std::string &path, WorkloadTrace &trace, std::string &error);
+    // build_graph adds the vertices and edges of the trace to the empty graph G, in the recorded order
+    void build_graph(const WorkloadTrace &trace, Graph &G);
+}
+
+#endif
@@ -52,59 +52,6 @@ Edge add_edge(Vertex u, Vertex v, Graph &G)
     return e;
 }
 
-void save_bench_to_file(const std::string &filename, const std::vector<std::vector<std::vector<double>>> &vec,
-                        const std::vector<int> &cases)
-{
-    for (auto c = 0; c < cases.size(); ++c)
-    {
-        std::ofstream file;
-        std::stringstream sstm;
-        sstm << filename << "_" << cases[c] << ".dat";
-        file.open(sstm.str(), std::ios::out | std::ios::trunc);
-        for (auto q = vec[c].begin(); q != vec[c].end(); ++q)
-        {
-            file << q->at(0) << "," << q->at(1) << std::endl;
-        }
-        file.close();
-    }
-}
-
-void save_bench_to_file(const std::string &filename, const std::vector<std::vector<std::vector<double>>> &vec,
-                        const std::vector<std::pair<int, int>> &cases)
-{
-    for (auto c = 0; c < cases.size(); ++c)
-    {
-        std::ofstream file;
-        std::stringstream sstm;
-        sstm << filename << "_" << cases[c].first << "_" << cases[c].second << ".dat";
-        file.open(sstm.str(), std::ios::out | std::ios::trunc);
-        for (auto q = vec[c].begin(); q != vec[c].end(); ++q)
-        {
-            file << q->at(0) << "," << q->at(1) << std::endl;
-        }
-        file.close();
-    }
-}
-
-void save_worst_case_to_file(const std::string &filename, const std::vector<double> &vec,
-                             const std::vector<int> &cases)
-{
-    std::ofstream file;
-    std::stringstream sstm;
-    sstm << filename << ".dat";
-    file.open(sstm.str(), std::ios::out | std::ios::trunc);
-    for (auto c = cases.begin(); c!= cases.end(); ++c)
-    {
-        file << *c << ",";
-    }
-    file << std::endl;
-    for (auto q = vec.begin(); q != vec.end(); ++q)
-    {
-        file << *q << std::endl;
-    }
-    file.close();
-}
-
 std::vector<int> powers_of_two(int num, int start_with=1)
 {
     std::vector<int> p(num);
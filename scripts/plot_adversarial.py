@@ -0,0 +1,85 @@
+import json
+import math
+import sys
+
+import matplotlib.pyplot as plt
+
+# For every adversarial suite: the vertex and edge count of a case (params = [size, width]), the work the construction
+# is predicted to cause, and the ES bound it is plotted against, computed from n and m alone.
+
+# cost of one unit of work in the bounds, in ms: about one cache miss, which moving an edge between the sets of two
+# vertices takes at worst. It is fixed beforehand, not fitted to the measurements it is compared with.
+UNIT_COST_MS = 1e-4
+
+
+def bumps_work(size, width):
+    n = 1 + width * size
+    m = 2 * width + (size - 1) * width * width
+    # width * size^2 / 4 level increases, each moving the width edges to the previous layer
+    return n, m, width * width * size * size / 4.0
+
+
+def race_work(size, width):
+    n = 2 * (1 + width * size)
+    m = 2 * (width + (size - 1) * width * width) + 1
+    # process A scans a whole half, process B runs as long and is rewound
+    return n, m, m / 2.0
+
+
+def halving_work(size, width):
+    n = size * width
+    m = size * width * (width - 1) // 2 + size - 1
+    # every level of the halving scans and rewinds the whole graph once
+    return n, m, m * math.log2(size)
+
+
+SUITES = {
+    # O(m * n) updates over all deletions
+    "adversarial_bumps": (bumps_work, lambda n, m: m * n, "m * n"),
+    # O(m) for one scan of process A
+    "adversarial_race": (race_work, lambda n, m: m, "m"),
+    # O(m * log n) when every deletion halves a component
+    "adversarial_halving": (halving_work, lambda n, m: m * math.log2(n), "m * log(n)"),
+}
+
+
+def main():
+    filename = sys.argv[1] if len(sys.argv) > 1 else "../results/bench.json"
+    unit_cost = float(sys.argv[2]) if len(sys.argv) > 2 else UNIT_COST_MS
+    with open(filename, "r") as f:
+        results = json.load(f)
+
+    for suite in results["suites"]:
+        if suite["name"] not in SUITES:
+            continue
+        work, bound, bound_label = SUITES[suite["name"]]
+
+        # group the cases by width, every width is a line, with the bound of each case next to its time
+        by_width = {}
+        for case in suite["cases"]:
+            size, width = case["params"]
+            n, m, predicted = work(size, width)
+            by_width.setdefault(width, []).append((predicted, case["stats"]["reorg"]["mean"], unit_cost * bound(n, m)))
+        if not by_width:
+            continue
+
+        fig, ax = plt.subplots()
+        for width in sorted(by_width):
+            points = sorted(by_width[width])
+            line = ax.plot([w for (w, _, _) in points], [t for (_, t, _) in points], "o-", label="width " + str(width))
+            ax.plot([w for (w, _, _) in points], [b for (_, _, b) in points], "--", color=line[0].get_color(),
+                    label="bound, width %d: %.3g ms * %s" % (width, unit_cost, bound_label))
+
+        ax.set_xscale("log")
+        ax.set_yscale("log")
+        ax.set_title(suite["name"])
+        ax.set_xlabel("Predicted work")
+        ax.set_ylabel("Total reorganization time (" + suite["unit"] + ")")
+        ax.legend()
+
+        fig.savefig("../plots/" + suite["name"] + ".png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#include "adversarial.hpp"
+#include <cassert>
+#include <queue>
+
+using namespace boost;
+
+namespace
+{
+    // add_bundle adds layers layers of width vertices after hub, joins hub to the first layer and every layer to the next,
+    // and returns the first vertex of the last layer
+    Vertex add_bundle(Graph &G, Vertex hub, int layers, int width, std::vector<Edge> &edge_handles)
+    {
+        Vertex first = num_vertices(G);
+        for (int i = 0; i < layers * width; ++i)
+        {
+            add_vertex(G);
+        }
+        for (int j = 0; j < width; ++j)
+        {
+            edge_handles.push_back(add_edge(hub, first + j, G).first);
+        }
+        for (int l = 1; l < layers; ++l)
+        {
+            Vertex previous = first + (l - 1) * width;
+            Vertex current = first + l * width;
+            for (int i = 0; i < width; ++i)
+            {
+                for (int j = 0; j < width; ++j)
+                {
+                    edge_handles.push_back(add_edge(previous + i, current + j, G).first);
+                }
+            }
+        }
+        return first + (layers - 1) * width;
+    }
+}
+
+std::vector<Vertex> gen::halving_sequence(int n)
+{
+    assert((n > 0) && ((n & (n - 1)) == 0));
+    std::vector<Vertex> seq;
+    std::queue<Vertex> vq;
+    int level = n / 4;
+    int limit = 1;
+    int limit_counter = 0;
+    vq.push(n / 2);
+    for (int q = 0; q < n - 1; ++q)
+    {
+        Vertex current = vq.front();
+        vq.pop();
+        seq.push_back(current);
+
+        vq.push(current - level);
+        vq.push(current + level);
+
+        ++limit_counter;
+        if (limit_counter == limit)
+        {
+            level /= 2;
+            limit *= 2;
+            limit_counter = 0;
+        }
+    }
+    return seq;
+}
+
+gen::Workload gen::adversarial_level_bumps(Graph &G, int layers, int width, std::vector<Edge> &edge_handles)
+{
+    assert(layers > 1 && width > 0 && num_vertices(G) == 0);
+    Workload workload;
+    workload.root = add_vertex(G);
+    Vertex last = add_bundle(G, workload.root, layers, width, edge_handles);
+    // close the ring through the root
+    for (int j = 0; j < width; ++j)
+    {
+        edge_handles.push_back(add_edge(last + j, workload.root, G).first);
+    }
+    // every deletion but the last only lifts its first layer vertex above the second layer, which keeps a parent in the
+    // first layer until the last deletion
+    for (int j = 0; j < width; ++j)
+    {
+        workload.deletions.push_back(std::make_pair(workload.root, workload.root + 1 + j));
+    }
+    return workload;
+}
+
+gen::Workload gen::adversarial_race(Graph &G, int layers, int width, std::vector<Edge> &edge_handles)
+{
+    assert(layers > 0 && width > 0 && num_vertices(G) == 0);
+    Workload workload;
+    Vertex hub1 = add_vertex(G);
+    add_bundle(G, hub1, layers, width, edge_handles);
+    Vertex hub2 = add_vertex(G);
+    add_bundle(G, hub2, layers, width, edge_handles);
+    edge_handles.push_back(add_edge(hub1, hub2, G).first);
+    workload.root = hub1;
+    workload.deletions.push_back(std::make_pair(hub2, hub1));
+    return workload;
+}
+
+gen::Workload gen::adversarial_halving(Graph &G, int segments, int width, std::vector<Edge> &edge_handles)
+{
+    assert(segments > 1 && width > 0 && num_vertices(G) == 0);
+    for (int i = 0; i < segments * width; ++i)
+    {
+        add_vertex(G);
+    }
+    for (int s = 0; s < segments; ++s)
+    {
+        Vertex first = s * width;
+        for (int i = 0; i < width; ++i)
+        {
+            for (int j = i + 1; j < width; ++j)
+            {
+                edge_handles.push_back(add_edge(first + i, first + j, G).first);
+            }
+        }
+        if (s > 0)
+        {
+            // the last vertex of the previous clique to the first of this one
+            edge_handles.push_back(add_edge(first - 1, first, G).first);
+        }
+    }
+    Workload workload;
+    workload.root = 0;
+    std::vector<Vertex> seq = halving_sequence(segments);
+    for (auto it = seq.begin(); it != seq.end(); ++it)
+    {
+        Vertex first = *it * width;
+        workload.deletions.push_back(std::make_pair(first, first - 1));
+    }
+    return workload;
+}
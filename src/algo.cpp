@@ -5,10 +5,10 @@
 
 using namespace boost;
 
-void my::bfs(const Graph &G, Vertex s, std::vector<int> &levels, std::vector<int> &comp, int comp_val,
-             std::vector<EdgeSet> &alpha,
-             std::vector<EdgeSet> &beta,
-             std::vector<EdgeSet> &gamma,
+void my::bfs(const Graph &G, Vertex s, my::StateVector<int> &levels, my::StateVector<int> &comp, int comp_val,
+             my::StateVector<EdgeSet> &alpha,
+             my::StateVector<EdgeSet> &beta,
+             my::StateVector<EdgeSet> &gamma,
              int levels_offset)
 {
     std::queue<Vertex> q;
@@ -58,7 +58,7 @@ void my::bfs(const Graph &G, Vertex s, std::vector<int> &levels, std::vector<int
     }
 }
 
-void my::dfs(const Graph &G, Vertex s, std::vector<int> &comp, int comp_val)
+void my::dfs(const Graph &G, Vertex s, my::StateVector<int> &comp, int comp_val)
 {
     std::stack<Vertex> stack;
     comp[s] = comp_val;
@@ -81,6 +81,68 @@ void my::dfs(const Graph &G, Vertex s, std::vector<int> &comp, int comp_val)
     }
 }
 
+Vertex my::bfs_farthest(const Graph &G, Vertex s, std::vector<Vertex> &parent)
+{
+    parent.assign(num_vertices(G), num_vertices(G));
+    std::queue<Vertex> q;
+    parent[s] = s;
+    q.push(s);
+    Vertex last = s;
+
+    while (!q.empty())
+    {
+        Vertex u = q.front();
+        q.pop();
+        last = u;
+        OutEdgeIterator ei, eiend;
+        for (tie(ei, eiend) = out_edges(u, G); ei != eiend; ++ei)
+        {
+            Vertex v = target(*ei, G);
+            if (parent[v] == num_vertices(G))
+            {
+                parent[v] = u;
+                q.push(v);
+            }
+        }
+    }
+    return last;
+}
+
+Vertex my::approximate_center(const Graph &G, Vertex s)
+{
+    std::vector<Vertex> parent;
+    // first sweep finds one end of a long shortest path, the second sweep finds the other end
+    Vertex a = bfs_farthest(G, s, parent);
+    Vertex b = bfs_farthest(G, a, parent);
+
+    // walk from b back towards a, stopping halfway
+    std::size_t length = 0;
+    for (Vertex w = b; w != a; w = parent[w])
+    {
+        ++length;
+    }
+    Vertex center = b;
+    for (std::size_t i = 0; i < length / 2; ++i)
+    {
+        center = parent[center];
+    }
+    return center;
+}
+
+Vertex my::highest_degree_vertex(const Graph &G)
+{
+    Vertex best = vertex(0, G);
+    VertexIterator vi, viend;
+    for (tie(vi, viend) = vertices(G); vi != viend; ++vi)
+    {
+        if (out_degree(*vi, G) > out_degree(best, G))
+        {
+            best = *vi;
+        }
+    }
+    return best;
+}
+
 bool my::dfs_scan(const Graph &G, Vertex s, Vertex t)
 {
     std::stack<Vertex> stack;
@@ -247,7 +309,7 @@ void my::StepScanDFS::advance()
     }
 }
 
-void my::circuit_free_update_components(const Graph &G, Vertex u, Vertex v, std::vector<int> &comps, int new_comp_val)
+void my::circuit_free_update_components(const Graph &G, Vertex u, Vertex v, my::StateVector<int> &comps, int new_comp_val)
 {
     // initialize a step DFS from both ends specified
     // not in target mode, since we know for a fact that a circuit free connected component breaks for every edge deletion
@@ -269,7 +331,7 @@ void my::circuit_free_update_components(const Graph &G, Vertex u, Vertex v, std:
     }
 }
 
-my::StepDetectBreak::StepDetectBreak(const Graph &G, Vertex u, Vertex v) : state(StepDetectBreakState::FirstBranch), component_breaks(false), _G(G), sdfs1(G, u, v), sdfs2(G, v, u)
+my::StepDetectBreak::StepDetectBreak(const Graph &G, Vertex u, Vertex v, int branch_quantum, ReorgCounters *counters) : state(StepDetectBreakState::FirstBranch), component_breaks(false), _G(G), _branch_quantum(branch_quantum), _counters(counters), sdfs1(G, u, v), sdfs2(G, v, u)
 {
 }
 
@@ -278,7 +340,6 @@ void my::StepDetectBreak::advance()
     switch (state)
     {
     case StepDetectBreakState::FirstBranch:
-        // advance first branch search by one step
         if (sdfs1.state == StepScanState::Finished)
         {
             if (!sdfs1.result)
@@ -292,7 +353,12 @@ void my::StepDetectBreak::advance()
             return;
         }
 
-        sdfs1.advance();
+        // advance first branch search by up to one quantum of steps
+        for (int i = 0; i < _branch_quantum && sdfs1.state != StepScanState::Finished; ++i)
+        {
+            sdfs1.advance();
+            DYN_COUNT(_counters, a_steps[0], 1);
+        }
 
         // switch to the other branch
         state = StepDetectBreakState::SecondBranch;
@@ -311,7 +377,11 @@ void my::StepDetectBreak::advance()
             return;
         }
 
-        sdfs2.advance();
+        for (int i = 0; i < _branch_quantum && sdfs2.state != StepScanState::Finished; ++i)
+        {
+            sdfs2.advance();
+            DYN_COUNT(_counters, a_steps[1], 1);
+        }
 
         // switch back to first branch
         state = StepDetectBreakState::FirstBranch;
@@ -323,9 +393,9 @@ void my::StepDetectBreak::advance()
     }
 }
 
-my::StepDetectNotBreak::StepDetectNotBreak(std::vector<int> &levels, std::vector<EdgeSet> &alpha, std::vector<EdgeSet> &beta,
-                                           std::vector<EdgeSet> &gamma, std::stack<ChangeRecord> &changes_stack,
-                                           Vertex u, Vertex v) : _levels(levels), _alpha(alpha), _beta(beta), _gamma(gamma), _u(u), _v(v), component_breaks(false), _changes_stack(changes_stack)
+my::StepDetectNotBreak::StepDetectNotBreak(my::StateVector<int> &levels, my::StateVector<EdgeSet> &alpha, my::StateVector<EdgeSet> &beta,
+                                           my::StateVector<EdgeSet> &gamma, std::stack<ChangeRecord> &changes_stack,
+                                           Vertex u, Vertex v, ReorgCounters *counters, std::vector<Vertex> *bumped) : _levels(levels), _alpha(alpha), _beta(beta), _gamma(gamma), _u(u), _v(v), component_breaks(false), level_bumps(0), _counters(counters), _bumped(bumped), _changes_stack(changes_stack)
 {
     _init();
 }
@@ -354,6 +424,8 @@ void my::StepDetectNotBreak::_init()
 
 void my::StepDetectNotBreak::advance(bool record_changes)
 {
+    DYN_COUNT(_counters, b_steps[static_cast<int>(state)], 1);
+
     switch (state)
     {
     case StepDetectNotBreakState::InitialCheckLevels:
@@ -416,6 +488,12 @@ void my::StepDetectNotBreak::advance(bool record_changes)
 
         // increase popped vertex level
         ++_levels[_current_w];
+        ++level_bumps;
+        DYN_COUNT(_counters, level_bumps, 1);
+        if (_bumped)
+        {
+            _bumped->push_back(_current_w);
+        }
         if (record_changes)
         {
             // add change to stack
@@ -442,6 +520,7 @@ void my::StepDetectNotBreak::advance(bool record_changes)
         // remove current edge from beta(w') and insert into gamma(w')
         _beta[w_prime].remove_edge(_current_w, w_prime);
         _gamma[w_prime].add_edge(_current_w, w_prime);
+        DYN_COUNT(_counters, edges_moved, 1);
 
         if (record_changes)
         {
@@ -476,6 +555,7 @@ void my::StepDetectNotBreak::advance(bool record_changes)
 
         // transfer beta(w) to alpha(w), beta(w) is now empty
         _alpha[_current_w] = std::move(_beta[_current_w]);
+        DYN_COUNT(_counters, sets_moved, 1);
 
         // initialize edge iterator for gamma(w)
         _current_esi = _gamma[_current_w].begin();
@@ -496,6 +576,7 @@ void my::StepDetectNotBreak::advance(bool record_changes)
         Vertex w_prime = _gamma[_current_w].other_end(_current_esi, _current_w);
         _alpha[w_prime].remove_edge(w_prime, _current_w);
         _beta[w_prime].add_edge(w_prime, _current_w);
+        DYN_COUNT(_counters, edges_moved, 1);
 
         if (record_changes)
         {
@@ -519,6 +600,7 @@ void my::StepDetectNotBreak::advance(bool record_changes)
         // gamma(w) is emptied inside the move
         _beta[_current_w] = std::move(_gamma[_current_w]);
         _gamma[_current_w].clear();
+        DYN_COUNT(_counters, sets_moved, 1);
         if (record_changes)
         {
             // NOTE: BetaGammaMoved not used any more, see _rewind notes
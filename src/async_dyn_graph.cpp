@@ -0,0 +1,221 @@
+#include "async_dyn_graph.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+using namespace boost;
+
+AsyncDynGraph::AsyncDynGraph(Graph &G, DynGraph &DG, std::size_t batch_size)
+    : _G(G), _DG(DG), _batch_size(batch_size), _head(&_stub), _tail(&_stub), _signal(0), _stop(false), _seq(0),
+      _pending_deletes(0)
+{
+    assert(DG._reroot_drift_factor <= 0.0 && "Re-rooting replaces the components read by the query fast path.");
+    assert(!DG._rebuild_thread.joinable() && "A background rebuild replaces the components read by the query fast path.");
+    assert(DG._live_forks == 0 && "The state is shared with forks.");
+    assert(!DG._async_attached && "Another AsyncDynGraph reads the components.");
+    DG._async_attached = true;
+    _stub.next.store(nullptr, std::memory_order_relaxed);
+    _engine = std::thread(&AsyncDynGraph::_run, this);
+}
+
+AsyncDynGraph::~AsyncDynGraph()
+{
+    _stop.store(true, std::memory_order_release);
+    _signal.fetch_add(1, std::memory_order_release);
+    _signal.notify_one();
+    _engine.join();
+    _DG._async_attached = false;
+}
+
+std::future<void> AsyncDynGraph::submit_delete(Edge e)
+{
+    Op *op = new Op();
+    op->type = OpType::DeleteEdge;
+    op->e = e;
+    std::future<void> f = op->done.get_future();
+    // counted before the push, so that a query submitted afterwards by the same thread sees it
+    _pending_deletes.fetch_add(1, std::memory_order_acq_rel);
+    _push(op);
+    return f;
+}
+
+std::future<void> AsyncDynGraph::submit_delete(Vertex u, Vertex v)
+{
+    Op *op = new Op();
+    op->type = OpType::DeleteEndpoints;
+    op->u = u;
+    op->v = v;
+    std::future<void> f = op->done.get_future();
+    _pending_deletes.fetch_add(1, std::memory_order_acq_rel);
+    _push(op);
+    return f;
+}
+
+std::future<bool> AsyncDynGraph::submit_query(Vertex u, Vertex v)
+{
+    bool answer;
+    if (_try_answer(u, v, answer))
+    {
+        std::promise<bool> p;
+        p.set_value(answer);
+        return p.get_future();
+    }
+
+    Op *op = new Op();
+    op->type = OpType::Query;
+    op->u = u;
+    op->v = v;
+    std::future<bool> f = op->answer.get_future();
+    _push(op);
+    return f;
+}
+
+bool AsyncDynGraph::_try_answer(Vertex u, Vertex v, bool &answer)
+{
+    std::uint64_t seq = _seq.load(std::memory_order_acquire);
+    if (seq & 1)
+    {
+        // a deletion is being applied right now
+        return false;
+    }
+    std::size_t pending = _pending_deletes.load(std::memory_order_acquire);
+    // the engine writes the components without atomics, the sequence check below discards any read that overlapped a write
+    int cu = std::atomic_ref<int>(_DG._components[u]).load(std::memory_order_relaxed);
+    int cv = std::atomic_ref<int>(_DG._components[v]).load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_seq.load(std::memory_order_relaxed) != seq)
+    {
+        return false;
+    }
+
+    if (cu != cv)
+    {
+        // disconnected vertices are never connected again
+        answer = false;
+        return true;
+    }
+    if (pending == 0)
+    {
+        answer = true;
+        return true;
+    }
+    return false;
+}
+
+void AsyncDynGraph::_push(Op *op)
+{
+    op->next.store(nullptr, std::memory_order_relaxed);
+    Op *prev = _head.exchange(op, std::memory_order_acq_rel);
+    prev->next.store(op, std::memory_order_release);
+
+    _signal.fetch_add(1, std::memory_order_release);
+    _signal.notify_one();
+}
+
+AsyncDynGraph::Op *AsyncDynGraph::_pop()
+{
+    Op *tail = _tail;
+    Op *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &_stub)
+    {
+        if (next == nullptr)
+        {
+            return nullptr;
+        }
+        // skip over the stub
+        _tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr)
+    {
+        _tail = next;
+        return tail;
+    }
+    if (tail != _head.load(std::memory_order_acquire))
+    {
+        // a producer has exchanged the head but not linked its node yet, try again later
+        return nullptr;
+    }
+    // tail is the last node, put the stub behind it so that it can be taken out
+    _push(&_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr)
+    {
+        _tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void AsyncDynGraph::_run()
+{
+    std::vector<Op *> batch;
+    batch.reserve(_batch_size);
+
+    while (true)
+    {
+        std::uint64_t signal = _signal.load(std::memory_order_acquire);
+
+        // take a batch off the queue, then apply it in submission order
+        batch.clear();
+        Op *op;
+        while (batch.size() < _batch_size && (op = _pop()) != nullptr)
+        {
+            batch.push_back(op);
+        }
+        for (auto it = batch.begin(); it != batch.end(); ++it)
+        {
+            _apply(*it);
+            delete *it;
+        }
+
+        if (batch.empty())
+        {
+            if (_stop.load(std::memory_order_acquire) && _head.load(std::memory_order_acquire) == _tail)
+            {
+                return;
+            }
+            if (_DG.compaction_pending())
+            {
+                // spend the idle time on the edge set compaction, in slices so that a submission waits for one at most
+                _DG.compact_edge_sets(IDLE_COMPACTION_SLICE);
+                continue;
+            }
+            // sleep until the next push, unless one happened since the signal was read
+            _signal.wait(signal, std::memory_order_acquire);
+        }
+    }
+}
+
+void AsyncDynGraph::_apply(Op *op)
+{
+    if (op->type == OpType::Query)
+    {
+        op->answer.set_value(_DG.query_is_connected(op->u, op->v));
+        return;
+    }
+
+    bool found = true;
+    _seq.fetch_add(1, std::memory_order_acq_rel);
+    if (op->type == OpType::DeleteEndpoints)
+    {
+        // through the endpoint index, no scan of the out-edges
+        found = _DG.dyn_remove_edge(op->u, op->v);
+    }
+    else
+    {
+        _DG.dyn_remove_edge(op->e);
+    }
+    _seq.fetch_add(1, std::memory_order_release);
+    _pending_deletes.fetch_sub(1, std::memory_order_acq_rel);
+
+    if (found)
+    {
+        op->done.set_value();
+    }
+    else
+    {
+        op->done.set_exception(std::make_exception_ptr(std::invalid_argument("no edge between the given vertices")));
+    }
+}
@@ -0,0 +1,650 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // splitmix64 finalizer, spreads nearby seeds over the whole range
+    std::uint64_t mix(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::uint64_t case_seed(std::uint64_t seed, const std::string &suite, const std::vector<long> &params)
+    {
+        // depends on the suite name and parameters only, so selecting a subset of suites or cases does not change the seeds
+        std::uint64_t h = mix(seed);
+        for (auto it = suite.begin(); it != suite.end(); ++it)
+        {
+            h = mix(h ^ static_cast<std::uint64_t>(*it));
+        }
+        for (auto it = params.begin(); it != params.end(); ++it)
+        {
+            h = mix(h ^ static_cast<std::uint64_t>(*it));
+        }
+        return h;
+    }
+
+    std::string case_label(const std::vector<long> &params, const std::string &separator)
+    {
+        std::stringstream sstm;
+        for (std::size_t i = 0; i < params.size(); ++i)
+        {
+            sstm << (i > 0 ? separator : "") << params[i];
+        }
+        return sstm.str();
+    }
+
+    std::vector<std::string> split(const std::string &s, char delim)
+    {
+        std::vector<std::string> parts;
+        std::stringstream sstm(s);
+        std::string part;
+        while (std::getline(sstm, part, delim))
+        {
+            if (!part.empty())
+            {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    void usage(const char *prog)
+    {
+        std::cerr << "usage: " << prog << " [options]\n"
+                  << "  --list                 list the available suites and exit\n"
+                  << "  --suite a,b,...        suites to run (default: all)\n"
+                  << "  --cases 256,2048       cases overriding the suite defaults, parameters joined with x (500x2000)\n"
+                  << "  --iterations N         measured runs per case (default: 100)\n"
+                  << "  --warmup N             discarded runs per case before measuring (default: 2)\n"
+                  << "  --seed S               base seed (default: 1072558)\n"
+                  << "  --json PATH            JSON output (default: ../results/bench.json)\n"
+                  << "  --dat-dir DIR          directory of the .dat files for the plotting scripts, empty to skip\n"
+                  << "  --per-query            include per-query statistics in the JSON output\n"
+                  << "  --jobs N               runs in parallel, 0 for one per physical core (default: 1)\n"
+                  << "  --no-pin               do not pin the benchmark threads to physical cores\n";
+    }
+
+    void json_stats(std::ostream &out, const bench::Stats &s)
+    {
+        out << "{\"count\": " << s.count << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90
+            << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+    }
+
+    typedef std::vector<std::pair<std::string, my::LatencyHistogram>> Latencies;
+
+    // histograms reported by the run on this thread, null while nothing is collected (e.g. during warmup)
+    thread_local Latencies *run_latencies = nullptr;
+
+    // CaseResults collects the measured runs of one case, from whichever thread performed them
+    struct CaseResults
+    {
+        std::mutex mutex;
+        // samples[query][column][iteration], sized by the first run to finish, every run writes its own iteration
+        std::vector<std::vector<std::vector<float>>> samples;
+        // latencies[iteration] holds the histograms reported by that run
+        std::vector<Latencies> latencies;
+    };
+
+    // available_cpus lists the logical cpus this process may run on, in order
+    std::vector<int> available_cpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (cpus.empty())
+        {
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // cpu_list parses a sysfs cpu list like "0,4" or "0-1" into cpus, returns false if it cannot
+    bool cpu_list(const std::string &list, std::vector<int> &cpus)
+    {
+        std::stringstream in(list);
+        std::string range;
+        while (std::getline(in, range, ','))
+        {
+            char *end = nullptr;
+            long lo = std::strtol(range.c_str(), &end, 10);
+            long hi = lo;
+            if (end == range.c_str())
+            {
+                return false;
+            }
+            if (*end == '-')
+            {
+                hi = std::strtol(end + 1, &end, 10);
+            }
+            for (long cpu = lo; cpu <= hi; ++cpu)
+            {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return !cpus.empty();
+    }
+
+    // physical_cores keeps one of the available cpus per physical core, the first of its SMT siblings. Two runs on siblings
+    // share the caches and the execution units of the core, so they would slow each other down as much as on one cpu.
+    std::vector<int> physical_cores()
+    {
+        std::vector<int> cpus = available_cpus();
+        std::vector<int> cores;
+        std::vector<int> taken;
+        for (auto it = cpus.begin(); it != cpus.end(); ++it)
+        {
+            if (std::find(taken.begin(), taken.end(), *it) != taken.end())
+            {
+                continue;
+            }
+            cores.push_back(*it);
+            std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(*it) + "/topology/thread_siblings_list");
+            std::string list;
+            std::vector<int> siblings;
+            // without the topology every cpu counts as a core
+            if (in >> list && cpu_list(list, siblings))
+            {
+                taken.insert(taken.end(), siblings.begin(), siblings.end());
+            }
+        }
+        return cores;
+    }
+
+    // pin_to restricts the calling thread to one core, where pinning is not supported it does nothing
+    void pin_to(int cpu)
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+
+    // run_cases performs every measured run of every case on jobs threads. Runs are handed out case by case, in iteration
+    // order, and a thread performs the warmup runs of a case before its first measured run of that case, so every thread
+    // measures with warm caches and allocator. The results do not depend on which thread performed a run.
+    void run_cases(const bench::Suite &suite, const std::vector<std::vector<long>> &cases, const std::vector<std::uint64_t> &seeds,
+                   int iterations, int warmup, int jobs, bool pin, std::vector<std::unique_ptr<CaseResults>> &results)
+    {
+        long tasks = static_cast<long>(cases.size()) * iterations;
+        std::atomic<long> next(0);
+        std::vector<int> cpus = physical_cores();
+
+        auto worker = [&](int index)
+        {
+            if (pin)
+            {
+                pin_to(cpus[index % cpus.size()]);
+            }
+            long warm_case = -1;
+            for (long t = next++; t < tasks; t = next++)
+            {
+                long c = t / iterations;
+                int iter = static_cast<int>(t % iterations);
+                const std::vector<long> &params = cases[c];
+                if (c != warm_case)
+                {
+                    // warmup runs repeat the first measured inputs
+                    for (int w = 0; w < warmup; ++w)
+                    {
+                        bench::Times times;
+                        suite.run(params, seeds[c], w, times);
+                    }
+                    warm_case = c;
+                }
+
+                CaseResults &result = *results[c];
+                bench::Times times;
+                run_latencies = &result.latencies[iter];
+                suite.run(params, seeds[c], iter, times);
+                run_latencies = nullptr;
+
+                std::lock_guard<std::mutex> lock(result.mutex);
+                if (result.samples.empty() && !times.empty())
+                {
+                    result.samples.assign(times.size(), std::vector<std::vector<float>>(
+                                                            suite.columns.size(), std::vector<float>(iterations, 0.0f)));
+                }
+                assert(times.size() == result.samples.size() && "Every run of a case must perform the same number of queries.");
+                for (std::size_t q = 0; q < times.size(); ++q)
+                {
+                    for (std::size_t col = 0; col < suite.columns.size(); ++col)
+                    {
+                        result.samples[q][col][iter] = static_cast<float>(times[q][col]);
+                    }
+                }
+            }
+        };
+
+        // even a single job runs on a thread of its own, so that pinning it leaves the calling thread as it was
+        std::vector<std::thread> pool;
+        for (int j = 0; j < jobs; ++j)
+        {
+            pool.push_back(std::thread(worker, j));
+        }
+        for (auto it = pool.begin(); it != pool.end(); ++it)
+        {
+            it->join();
+        }
+    }
+
+    void json_latency(std::ostream &out, const my::LatencyHistogram &h)
+    {
+        out << "{\"count\": " << h.count() << ", \"mean\": " << my::ticks_to_ms(h.mean())
+            << ", \"p50\": " << my::ticks_to_ms(h.percentile(50)) << ", \"p90\": " << my::ticks_to_ms(h.percentile(90))
+            << ", \"p99\": " << my::ticks_to_ms(h.percentile(99)) << ", \"p999\": " << my::ticks_to_ms(h.percentile(99.9))
+            << ", \"max\": " << my::ticks_to_ms(h.max()) << "}";
+    }
+
+    std::string json_string(const std::string &s)
+    {
+        std::string res = "\"";
+        for (auto it = s.begin(); it != s.end(); ++it)
+        {
+            if (*it == '"' || *it == '\\')
+            {
+                res += '\\';
+            }
+            res += *it;
+        }
+        return res + "\"";
+    }
+}
+
+std::uint64_t bench::iteration_seed(std::uint64_t case_seed, int iteration)
+{
+    return mix(case_seed ^ mix(static_cast<std::uint64_t>(iteration)));
+}
+
+void bench::report_latency(const std::string &name, const my::LatencyHistogram &histogram)
+{
+    if (run_latencies == nullptr)
+    {
+        return;
+    }
+    for (auto it = run_latencies->begin(); it != run_latencies->end(); ++it)
+    {
+        if (it->first == name)
+        {
+            it->second += histogram;
+            return;
+        }
+    }
+    run_latencies->push_back(std::make_pair(name, histogram));
+}
+
+bench::Stats bench::compute_stats(std::vector<float> &samples)
+{
+    Stats s = {samples.size(), 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (samples.empty())
+    {
+        return s;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (auto it = samples.begin(); it != samples.end(); ++it)
+    {
+        sum += *it;
+    }
+    s.mean = sum / samples.size();
+
+    // nearest-rank percentile
+    auto rank = [&samples](double p)
+    {
+        std::size_t idx = static_cast<std::size_t>(std::ceil(p * samples.size()));
+        return static_cast<double>(samples[std::max<std::size_t>(idx, 1) - 1]);
+    };
+    s.p50 = rank(0.50);
+    s.p90 = rank(0.90);
+    s.p99 = rank(0.99);
+    s.max = samples.back();
+    return s;
+}
+
+bool bench::parse_args(int argc, char **argv, Config &config, bool &list)
+{
+    list = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--list")
+        {
+            list = true;
+            continue;
+        }
+        if (arg == "--per-query")
+        {
+            config.per_query = true;
+            continue;
+        }
+        if (arg == "--no-pin")
+        {
+            config.pin = false;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--suite")
+        {
+            config.suites = split(value, ',');
+        }
+        else if (arg == "--cases")
+        {
+            config.cases.clear();
+            std::vector<std::string> cases = split(value, ',');
+            for (auto it = cases.begin(); it != cases.end(); ++it)
+            {
+                std::vector<long> params;
+                std::vector<std::string> parts = split(*it, 'x');
+                for (auto p = parts.begin(); p != parts.end(); ++p)
+                {
+                    params.push_back(std::atol(p->c_str()));
+                }
+                config.cases.push_back(params);
+            }
+        }
+        else if (arg == "--iterations")
+        {
+            config.iterations = std::atoi(value.c_str());
+        }
+        else if (arg == "--warmup")
+        {
+            config.warmup = std::atoi(value.c_str());
+        }
+        else if (arg == "--jobs")
+        {
+            config.jobs = std::atoi(value.c_str());
+        }
+        else if (arg == "--seed")
+        {
+            config.seed = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (arg == "--json")
+        {
+            config.json_path = value;
+        }
+        else if (arg == "--dat-dir")
+        {
+            config.dat_dir = value;
+        }
+        else
+        {
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (config.iterations <= 0 || config.warmup < 0 || config.jobs < 0)
+    {
+        usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+void bench::print_suites(const std::vector<Suite> &suites)
+{
+    for (auto it = suites.begin(); it != suites.end(); ++it)
+    {
+        std::cout << it->name << ": " << it->description << std::endl
+                  << "    default cases:";
+        for (auto c = it->default_cases.begin(); c != it->default_cases.end(); ++c)
+        {
+            std::cout << " " << case_label(*c, "x");
+        }
+        std::cout << std::endl;
+    }
+}
+
+int bench::run(const Config &config, const std::vector<Suite> &suites)
+{
+    // resolve the selected suites first, so that a typo does not surface after hours of benchmarking
+    std::vector<const Suite *> selected;
+    if (config.suites.empty())
+    {
+        for (auto it = suites.begin(); it != suites.end(); ++it)
+        {
+            selected.push_back(&(*it));
+        }
+    }
+    for (auto name = config.suites.begin(); name != config.suites.end(); ++name)
+    {
+        auto it = std::find_if(suites.begin(), suites.end(), [&name](const Suite &s)
+                               { return s.name == *name; });
+        if (it == suites.end())
+        {
+            std::cerr << "unknown suite: " << *name << std::endl;
+            return 1;
+        }
+        selected.push_back(&(*it));
+    }
+    for (auto it = selected.begin(); it != selected.end(); ++it)
+    {
+        for (auto c = config.cases.begin(); c != config.cases.end(); ++c)
+        {
+            if (c->size() != (*it)->default_cases.front().size())
+            {
+                std::cerr << "suite " << (*it)->name << " takes " << (*it)->default_cases.front().size()
+                          << " parameter(s) per case, got " << case_label(*c, "x") << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::ofstream json;
+    json.open(config.json_path, std::ios::out | std::ios::trunc);
+    if (!json)
+    {
+        std::cerr << "cannot write " << config.json_path << std::endl;
+        return 1;
+    }
+    // calibrate the clock before the benchmark threads start, not inside the first measured run
+    my::ticks_per_ns();
+    std::size_t cores = physical_cores().size();
+    if (config.jobs > static_cast<int>(cores))
+    {
+        std::cerr << "warning: " << config.jobs << " jobs on " << cores
+                  << " physical cores, the runs share cores and their times include each other" << std::endl;
+    }
+    json << "{\n  \"config\": {\"iterations\": " << config.iterations << ", \"warmup\": " << config.warmup
+         << ", \"seed\": " << config.seed << ", \"jobs\": " << config.jobs << ", \"pin\": " << (config.pin ? "true" : "false")
+         << "},\n  \"suites\": [";
+
+    for (std::size_t si = 0; si < selected.size(); ++si)
+    {
+        const Suite &suite = *selected[si];
+        const std::vector<std::vector<long>> &cases = config.cases.empty() ? suite.default_cases : config.cases;
+        std::cout << "suite " << suite.name << std::endl;
+        int iterations = suite.deterministic ? 1 : config.iterations;
+        int warmup = suite.deterministic ? 0 : config.warmup;
+
+        json << (si > 0 ? "," : "") << "\n    {\"name\": " << json_string(suite.name) << ", \"unit\": " << json_string(suite.unit)
+             << ", \"columns\": [";
+        for (std::size_t col = 0; col < suite.columns.size(); ++col)
+        {
+            json << (col > 0 ? ", " : "") << json_string(suite.columns[col]);
+        }
+        json << "], \"cases\": [";
+
+        std::vector<std::uint64_t> seeds;
+        std::vector<std::unique_ptr<CaseResults>> results;
+        for (auto c = cases.begin(); c != cases.end(); ++c)
+        {
+            seeds.push_back(case_seed(config.seed, suite.name, *c));
+            results.emplace_back(new CaseResults());
+            results.back()->latencies.resize(iterations);
+        }
+        // never more threads than runs, the rest would only warm up
+        long runs = static_cast<long>(cases.size()) * iterations;
+        int jobs = static_cast<int>(std::min<long>(config.jobs == 0 ? cores : config.jobs, runs));
+        run_cases(suite, cases, seeds, iterations, warmup, std::max(jobs, 1), config.pin, results);
+
+        // means of the first column of every case, for the Total .dat format
+        std::vector<double> totals;
+
+        for (std::size_t c = 0; c < cases.size(); ++c)
+        {
+            const std::vector<long> &params = cases[c];
+            std::uint64_t seed = seeds[c];
+            std::cout << "  case " << case_label(params, "x") << " (seed " << seed << ")" << std::endl;
+            // samples[query][column] holds one sample per iteration
+            std::vector<std::vector<std::vector<float>>> &samples = results[c]->samples;
+
+            // the histograms of all measured runs, merged in iteration order
+            Latencies case_latencies;
+            run_latencies = &case_latencies;
+            for (auto run = results[c]->latencies.begin(); run != results[c]->latencies.end(); ++run)
+            {
+                for (auto it = run->begin(); it != run->end(); ++it)
+                {
+                    report_latency(it->first, it->second);
+                }
+            }
+            run_latencies = nullptr;
+
+            json << (c > 0 ? "," : "") << "\n      {\"params\": [" << case_label(params, ", ") << "], \"seed\": " << seed
+                 << ", \"queries\": " << samples.size() << ", \"stats\": {";
+
+            // per-query means for the .dat output, computed before compute_stats reorders the samples
+            std::vector<std::vector<double>> means(samples.size(), std::vector<double>(suite.columns.size(), 0.0));
+            for (std::size_t q = 0; q < samples.size(); ++q)
+            {
+                for (std::size_t col = 0; col < suite.columns.size(); ++col)
+                {
+                    for (auto it = samples[q][col].begin(); it != samples[q][col].end(); ++it)
+                    {
+                        means[q][col] += *it;
+                    }
+                    means[q][col] /= iterations;
+                }
+            }
+
+            // aggregate over all queries and iterations: the latency distribution of a single operation
+            for (std::size_t col = 0; col < suite.columns.size(); ++col)
+            {
+                std::vector<float> all;
+                for (std::size_t q = 0; q < samples.size(); ++q)
+                {
+                    all.insert(all.end(), samples[q][col].begin(), samples[q][col].end());
+                }
+                Stats s = compute_stats(all);
+                json << (col > 0 ? ", " : "") << json_string(suite.columns[col]) << ": ";
+                json_stats(json, s);
+                std::cout << "    " << suite.columns[col] << ": mean " << s.mean << " p50 " << s.p50 << " p90 " << s.p90
+                          << " p99 " << s.p99 << " max " << s.max << " " << suite.unit << std::endl;
+            }
+            json << "}";
+
+            if (config.per_query)
+            {
+                json << ", \"per_query\": {";
+                for (std::size_t col = 0; col < suite.columns.size(); ++col)
+                {
+                    json << (col > 0 ? ", " : "") << json_string(suite.columns[col]) << ": [";
+                    for (std::size_t q = 0; q < samples.size(); ++q)
+                    {
+                        json << (q > 0 ? ", " : "");
+                        json_stats(json, compute_stats(samples[q][col]));
+                    }
+                    json << "]";
+                }
+                json << "}";
+            }
+
+            if (!case_latencies.empty())
+            {
+                json << ", \"latency\": {";
+                for (std::size_t h = 0; h < case_latencies.size(); ++h)
+                {
+                    const my::LatencyHistogram &hist = case_latencies[h].second;
+                    json << (h > 0 ? ", " : "") << json_string(case_latencies[h].first) << ": ";
+                    json_latency(json, hist);
+                    std::cout << "    " << case_latencies[h].first << " histogram: p50 " << my::ticks_to_ms(hist.percentile(50))
+                              << " p99 " << my::ticks_to_ms(hist.percentile(99)) << " p99.9 "
+                              << my::ticks_to_ms(hist.percentile(99.9)) << " ms" << std::endl;
+                }
+                json << "}";
+            }
+            json << "}";
+
+            if (!config.dat_dir.empty() && suite.dat_format == DatFormat::PerQuery)
+            {
+                std::ofstream file;
+                file.open(config.dat_dir + "/" + suite.dat_prefix + "_" + case_label(params, "_") + ".dat",
+                          std::ios::out | std::ios::trunc);
+                for (auto q = means.begin(); q != means.end(); ++q)
+                {
+                    for (std::size_t col = 0; col < q->size(); ++col)
+                    {
+                        file << (col > 0 ? "," : "") << q->at(col);
+                    }
+                    file << std::endl;
+                }
+                file.close();
+            }
+            totals.push_back(means.empty() ? 0.0 : means[0][0]);
+            // release the samples of the case once written
+            results[c].reset();
+        }
+        json << "]}";
+
+        if (!config.dat_dir.empty() && suite.dat_format == DatFormat::Total)
+        {
+            std::ofstream file;
+            file.open(config.dat_dir + "/" + suite.dat_prefix + ".dat", std::ios::out | std::ios::trunc);
+            for (auto c = cases.begin(); c != cases.end(); ++c)
+            {
+                file << case_label(*c, "_") << ",";
+            }
+            file << std::endl;
+            for (auto t = totals.begin(); t != totals.end(); ++t)
+            {
+                file << *t << std::endl;
+            }
+            file.close();
+        }
+    }
+    json << "\n  ]\n}\n";
+    json.close();
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "coro_algo.hpp"
+#include "algo.hpp"
+#include <exception>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+
+using namespace boost;
+
+// CORO_STEP marks the end of one step, matching one advance() of the corresponding state machine.
+// The coroutine suspends once "batch" steps have been performed since the last suspension.
+#define CORO_STEP(steps, batch)                \
+    if (++(steps) == (batch))                  \
+    {                                          \
+        (steps) = 0;                           \
+        co_await std::suspend_always{};        \
+    }
+
+// SCAN_STEP and B_STEP also count the step, in the same place the state machines count it
+#define SCAN_STEP(steps, batch)                    \
+    DYN_COUNT(counters, a_steps[branch], 1);       \
+    CORO_STEP(steps, batch)
+
+#define B_STEP(state, steps, batch)                                                  \
+    DYN_COUNT(counters, b_steps[static_cast<int>(StepDetectNotBreakState::state)], 1); \
+    CORO_STEP(steps, batch)
+
+void my::StepTask::promise_type::unhandled_exception()
+{
+    std::terminate();
+}
+
+my::StepTask::StepTask(std::coroutine_handle<promise_type> h) : _h(h)
+{
+}
+
+my::StepTask::StepTask(StepTask &&other) : _h(std::exchange(other._h, nullptr))
+{
+}
+
+my::StepTask &my::StepTask::operator=(StepTask &&other)
+{
+    if (this != &other)
+    {
+        if (_h)
+        {
+            _h.destroy();
+        }
+        _h = std::exchange(other._h, nullptr);
+    }
+    return *this;
+}
+
+my::StepTask::~StepTask()
+{
+    if (_h)
+    {
+        _h.destroy();
+    }
+}
+
+void my::StepTask::advance()
+{
+    if (!_h.done())
+    {
+        _h.resume();
+    }
+}
+
+bool my::StepTask::finished() const
+{
+    return _h.done();
+}
+
+my::StepTask my::coro_scan_dfs(const Graph &G, Vertex s, Vertex t, bool target_mode, ScanOutcome &out, int batch,
+                                 ReorgCounters *counters, int branch)
+{
+    out.result = false;
+    out.component.clear();
+    out.component.push_back(s);
+
+    // trivial check
+    if (target_mode && s == t)
+    {
+        out.result = true;
+        DYN_COUNT(counters, a_steps[branch], 1);
+        co_return;
+    }
+
+    std::stack<Vertex> stack;
+    // same as StepScanDFS, a set keeps the cost proportional to the part of the component scanned
+    std::unordered_set<Vertex> visited;
+    stack.push(s);
+    visited.insert(s);
+
+    int steps = 0;
+    while (!stack.empty())
+    {
+        Vertex current_v = stack.top();
+        stack.pop();
+
+        OutEdgeIterator ei, eiend;
+        tie(ei, eiend) = out_edges(current_v, G);
+        if (ei == eiend)
+        {
+            // no edges, next step examines a new vertex
+            SCAN_STEP(steps, batch);
+            continue;
+        }
+        SCAN_STEP(steps, batch);
+
+        for (; ei != eiend; ++ei)
+        {
+            Vertex w = target(*ei, G);
+            if (visited.find(w) == visited.end())
+            {
+                out.component.push_back(w);
+                if (target_mode && w == t)
+                {
+                    // scan complete, found vertex
+                    out.result = true;
+                    DYN_COUNT(counters, a_steps[branch], 1);
+                    co_return;
+                }
+                stack.push(w);
+                visited.insert(w);
+            }
+            SCAN_STEP(steps, batch);
+        }
+        // all edges of the current vertex have been examined
+        SCAN_STEP(steps, batch);
+    }
+    // finished scan, default result (false)
+}
+
+my::StepTask my::coro_detect_break(const Graph &G, Vertex u, Vertex v, BreakOutcome &out, int branch_quantum, int batch,
+                                     ReorgCounters *counters)
+{
+    out.component_breaks = false;
+    out.small_component.clear();
+
+    // one scan for each of the two subtrees, running in "parallel"
+    ScanOutcome outcome1, outcome2;
+    StepTask scan1 = coro_scan_dfs(G, u, v, true, outcome1, branch_quantum, counters, 0);
+    StepTask scan2 = coro_scan_dfs(G, v, u, true, outcome2, branch_quantum, counters, 1);
+
+    int steps = 0;
+    while (true)
+    {
+        if (scan1.finished())
+        {
+            if (!outcome1.result)
+            {
+                // the other end was not found, this branch holds the small component
+                out.small_component = std::move(outcome1.component);
+                out.component_breaks = true;
+            }
+            co_return;
+        }
+        scan1.advance();
+        CORO_STEP(steps, batch);
+
+        if (scan2.finished())
+        {
+            if (!outcome2.result)
+            {
+                out.small_component = std::move(outcome2.component);
+                out.component_breaks = true;
+            }
+            co_return;
+        }
+        scan2.advance();
+        CORO_STEP(steps, batch);
+    }
+}
+
+my::StepTask my::coro_detect_not_break(my::StateVector<int> &levels,
+                                       my::StateVector<EdgeSet> &alpha,
+                                       my::StateVector<EdgeSet> &beta,
+                                       my::StateVector<EdgeSet> &gamma,
+                                       std::stack<ChangeRecord> &changes_stack,
+                                       Vertex u, Vertex v,
+                                       const bool &record_changes,
+                                       std::size_t &level_bumps,
+                                       int batch,
+                                       ReorgCounters *counters,
+                                       std::vector<Vertex> *bumped)
+{
+    // the comments name the StepDetectNotBreakState each step corresponds to
+    int steps = 0;
+    level_bumps = 0;
+
+    // InitialCheckLevels
+    if (levels[u] == levels[v])
+    {
+        // same level means component does not break
+        beta[u].remove_edge(u, v);
+        beta[v].remove_edge(u, v);
+        DYN_COUNT(counters, b_steps[static_cast<int>(StepDetectNotBreakState::InitialCheckLevels)], 1);
+        co_return;
+    }
+    B_STEP(InitialCheckLevels, steps, batch);
+
+    // InitialDifferentLevels
+    if (levels[v] < levels[u])
+    {
+        // make u be the one with the smaller level of the two
+        std::swap(v, u);
+    }
+    gamma[u].remove_edge(u, v);
+    alpha[v].remove_edge(u, v);
+    if (!alpha[v].empty())
+    {
+        // components have not changed
+        DYN_COUNT(counters, b_steps[static_cast<int>(StepDetectNotBreakState::InitialDifferentLevels)], 1);
+        co_return;
+    }
+    B_STEP(InitialDifferentLevels, steps, batch);
+
+    // InitLevelAvalanche
+    std::queue<Vertex> Q;
+    Q.push(v);
+    B_STEP(InitLevelAvalanche, steps, batch);
+
+    while (true)
+    {
+        // AvalancheStep1_2_3
+        if (Q.empty())
+        {
+            DYN_COUNT(counters, b_steps[static_cast<int>(StepDetectNotBreakState::AvalancheStep1_2_3)], 1);
+            co_return;
+        }
+        Vertex w = Q.front();
+        Q.pop();
+        ++levels[w];
+        ++level_bumps;
+        DYN_COUNT(counters, level_bumps, 1);
+        if (bumped)
+        {
+            bumped->push_back(w);
+        }
+        if (record_changes)
+        {
+            changes_stack.push(ChangeRecord(ChangeRecordType::LevelBump, w, w, 0));
+        }
+        B_STEP(AvalancheStep1_2_3, steps, batch);
+
+        // AvalancheStep4
+        for (EdgeSetIterator esi = beta[w].begin(); esi != beta[w].end(); ++esi)
+        {
+            Vertex w_prime = beta[w].other_end(esi, w);
+            beta[w_prime].remove_edge(w, w_prime);
+            gamma[w_prime].add_edge(w, w_prime);
+            DYN_COUNT(counters, edges_moved, 1);
+            if (record_changes)
+            {
+                changes_stack.push(ChangeRecord(ChangeRecordType::Remove, w_prime, w, 1));
+                changes_stack.push(ChangeRecord(ChangeRecordType::Insert, w_prime, w, 2));
+            }
+            B_STEP(AvalancheStep4, steps, batch);
+        }
+        B_STEP(AvalancheStep4, steps, batch);
+
+        // AvalancheStep5
+        if (record_changes)
+        {
+            // see StepDetectNotBreak for why both records are needed
+            ChangeRecord abmove(ChangeRecordType::AlphaBetaMove, w, w, 0);
+            abmove.old_set = std::move(alpha[w]);
+            changes_stack.push(std::move(abmove));
+            changes_stack.push(ChangeRecord(ChangeRecordType::RestoreBeta, w, w, 0));
+        }
+        alpha[w] = std::move(beta[w]);
+        DYN_COUNT(counters, sets_moved, 1);
+        B_STEP(AvalancheStep5, steps, batch);
+
+        // AvalancheStep6
+        for (EdgeSetIterator esi = gamma[w].begin(); esi != gamma[w].end(); ++esi)
+        {
+            Vertex w_prime = gamma[w].other_end(esi, w);
+            alpha[w_prime].remove_edge(w_prime, w);
+            beta[w_prime].add_edge(w_prime, w);
+            DYN_COUNT(counters, edges_moved, 1);
+            if (record_changes)
+            {
+                changes_stack.push(ChangeRecord(ChangeRecordType::Remove, w_prime, w, 0));
+                changes_stack.push(ChangeRecord(ChangeRecordType::Insert, w_prime, w, 1));
+            }
+            if (alpha[w_prime].empty())
+            {
+                Q.push(w_prime);
+            }
+            B_STEP(AvalancheStep6, steps, batch);
+        }
+        B_STEP(AvalancheStep6, steps, batch);
+
+        // AvalancheStep7
+        beta[w] = std::move(gamma[w]);
+        gamma[w].clear();
+        DYN_COUNT(counters, sets_moved, 1);
+        if (record_changes)
+        {
+            changes_stack.push(ChangeRecord(ChangeRecordType::GammaEmptyMove, w, w, 0));
+        }
+        B_STEP(AvalancheStep7, steps, batch);
+
+        // AvalancheStep8
+        if (alpha[w].empty())
+        {
+            // alpha(w) is still empty, push to queue again
+            Q.push(w);
+        }
+        B_STEP(AvalancheStep8, steps, batch);
+    }
+}
@@ -0,0 +1,55 @@
+#include "counters.hpp"
+
+my::ReorgCounters::ReorgCounters()
+{
+    reset();
+}
+
+void my::ReorgCounters::reset()
+{
+    deletions = 0;
+    a_steps[0] = a_steps[1] = 0;
+    for (int i = 0; i < NUM_PROCESS_B_STATES; ++i)
+    {
+        b_steps[i] = 0;
+    }
+    level_bumps = 0;
+    edges_moved = 0;
+    sets_moved = 0;
+    records_pushed = 0;
+    records_rewound = 0;
+    small_component_size = 0;
+}
+
+my::ReorgCounters &my::ReorgCounters::operator+=(const ReorgCounters &other)
+{
+    deletions += other.deletions;
+    a_steps[0] += other.a_steps[0];
+    a_steps[1] += other.a_steps[1];
+    for (int i = 0; i < NUM_PROCESS_B_STATES; ++i)
+    {
+        b_steps[i] += other.b_steps[i];
+    }
+    level_bumps += other.level_bumps;
+    edges_moved += other.edges_moved;
+    sets_moved += other.sets_moved;
+    records_pushed += other.records_pushed;
+    records_rewound += other.records_rewound;
+    small_component_size += other.small_component_size;
+    return *this;
+}
+
+std::uint64_t my::ReorgCounters::total_a_steps() const
+{
+    return a_steps[0] + a_steps[1];
+}
+
+std::uint64_t my::ReorgCounters::total_b_steps() const
+{
+    std::uint64_t total = 0;
+    for (int i = 0; i < NUM_PROCESS_B_STATES; ++i)
+    {
+        total += b_steps[i];
+    }
+    return total;
+}
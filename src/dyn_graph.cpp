@@ -1,38 +1,110 @@
 #include "graph.hpp"
 #include <ctime>
+#include <algorithm>
+#include <cassert>
 #include <queue>
 #include <iostream>
+#include <malloc.h>
 #include <boost/random/mersenne_twister.hpp>
 #include "dyn_graph.hpp"
+#include "dyn_graph_fork.hpp"
 #include "algo.hpp"
 #include "edge_set.hpp"
+#include "coro_algo.hpp"
 
 using namespace boost;
 
-DynGraph::DynGraph(Graph &G) : _G(G), _component_max_idx(0)
+DynGraph::DynGraph(Graph &G) : DynGraph(G, 0, RootStrategy::Random, my::MemoryPolicy())
 {
-    init(true);
 }
-DynGraph::DynGraph(Graph &G, Vertex r) : _G(G), _component_max_idx(0), _r(r)
+
+DynGraph::DynGraph(Graph &G, Vertex r, const my::MemoryPolicy &memory) : DynGraph(G, r, RootStrategy::Fixed, memory)
+{
+}
+
+DynGraph::DynGraph(Graph &G, RootStrategy strategy, const my::MemoryPolicy &memory) : DynGraph(G, 0, strategy, memory)
+{
+}
+
+DynGraph::DynGraph(Graph &G, Vertex r, RootStrategy strategy, const my::MemoryPolicy &memory)
+    : _G(G), _r(r), _component_max_idx(0), _memory(memory), _engine(ReorgEngine::StateMachine), _change_log_peak(0),
+      _last_reorg_ticks(0), _track_latency(true), _deletions(0), _speculating(false), _speculation_mark(0),
+      _live_forks(0), _installed_fork(nullptr), _async_attached(false), _edge_index_built(false), _compact_min_load_factor(0.0),
+      _compact_per_deletion(0), _compact_trim_bytes(1 << 20), _compact_cursor(0), _compact_dirty(0), _compact_pass_deletions(0),
+      _compact_sweep_bytes(0), _trim_pending(false), _compaction_stats(),
+      _reroot_drift_factor(0.0), _reroot_min_deletions(0), _reroot_strategy(RootStrategy::Center), _reroot_background(false),
+      _rebuild_ready(false)
 {
-    init(false);
+    if (my::uses_region(_memory, my::RegionArena::CHUNK_SIZE))
+    {
+        _edge_arena.reset(new my::RegionArena(_memory));
+    }
+    init(strategy);
+}
+
+DynGraph::~DynGraph()
+{
+    if (_rebuild_thread.joinable())
+    {
+        _rebuild_thread.join();
+    }
 }
 
 void DynGraph::init(bool random_root)
 {
+    init(random_root ? RootStrategy::Random : RootStrategy::Fixed);
+}
 
-    _levels = std::vector<int>(num_vertices(_G), -1);
-    _components = std::vector<int>(num_vertices(_G), -1);
+void DynGraph::init(RootStrategy strategy)
+{
+    assert(_live_forks == 0 && "The state is shared with forks.");
+    assert(!_async_attached && "The components are read by an AsyncDynGraph.");
+    std::uint64_t t1 = _phases ? my::clock_ticks() : 0;
+    _levels = my::StateVector<int>(num_vertices(_G), -1, _memory);
+    _components = my::StateVector<int>(num_vertices(_G), -1, _memory);
     // initialze edge sets for each vertex
-    alpha = std::vector<EdgeSet>(num_vertices(_G));
-    beta = std::vector<EdgeSet>(num_vertices(_G));
-    gamma = std::vector<EdgeSet>(num_vertices(_G));
+    alpha = my::StateVector<EdgeSet>(num_vertices(_G), _memory);
+    beta = my::StateVector<EdgeSet>(num_vertices(_G), _memory);
+    gamma = my::StateVector<EdgeSet>(num_vertices(_G), _memory);
+    if (_edge_arena)
+    {
+        // the tables of the sets freed above go back to the arena, which is kept for the new ones
+        std::uint32_t arena = _edge_arena->id();
+        for (std::size_t i = 0; i < alpha.size(); ++i)
+        {
+            alpha[i].set_arena(arena);
+            beta[i].set_arena(arena);
+            gamma[i].set_arena(arena);
+        }
+    }
 
-    if (random_root)
+    switch (strategy)
+    {
+    case RootStrategy::Random:
     {
         // pick random vertex as root
         mt19937 mt(std::time(0));
         _r = vertex(mt() % num_vertices(_G), _G);
+        break;
+    }
+    case RootStrategy::HighestDegree:
+        _r = my::highest_degree_vertex(_G);
+        break;
+    case RootStrategy::Center:
+        // starting the sweep from the highest degree vertex makes it likely that the center is found in the largest component
+        _r = my::approximate_center(_G, my::highest_degree_vertex(_G));
+        break;
+    case RootStrategy::Fixed:
+    default:
+        break;
+    }
+
+    bool out_of_core = !_memory.directory.empty();
+    if (out_of_core)
+    {
+        // the arrays were filled in order, the BFS reaches them at random vertices and read ahead would only pull in pages
+        // that are not needed
+        _advise_state(my::Access::Random);
     }
 
     // perform initial BFS from root r
@@ -49,10 +121,36 @@ void DynGraph::init(bool random_root)
             my::bfs(_G, s, _levels, _components, ++_component_max_idx, alpha, beta, gamma, 1);
         }
     }
+
+    if (out_of_core)
+    {
+        my::advise_region(_levels.data(), _levels.size() * sizeof(int), my::Access::Sequential);
+    }
+    _level_sum = 0;
+    for (std::size_t i = 0; i < _levels.size(); ++i)
+    {
+        _level_sum += _levels[i];
+    }
+    _init_level_sum = _level_sum;
+    _deletions_since_init = 0;
+    if (out_of_core)
+    {
+        // Process B reaches the arrays at random vertices, like the BFS
+        _advise_state(my::Access::Random);
+    }
+    _publish_all();
+    if (_phases)
+    {
+        _phases->complete("init", my::PhaseTracer::Deletions, t1, my::clock_ticks(),
+                          {{"vertices", static_cast<long long>(num_vertices(_G))},
+                           {"edges", static_cast<long long>(num_edges(_G))},
+                           {"root", static_cast<long long>(_r)}});
+    }
 }
 
 void DynGraph::print()
 {
+    reclaim_state();
     VertexIterator vi, viend;
     for (tie(vi, viend) = vertices(_G); vi != viend; ++vi)
     {
@@ -66,11 +164,20 @@ void DynGraph::print()
     }
 }
 
-void DynGraph::_rewind()
+void DynGraph::_advise_state(my::Access access)
 {
-    std::vector<std::vector<EdgeSet> *> s = {&alpha, &beta, &gamma};
+    my::advise_region(_levels.data(), _levels.size() * sizeof(int), access);
+    my::advise_region(_components.data(), _components.size() * sizeof(int), access);
+    my::advise_region(alpha.data(), alpha.size() * sizeof(EdgeSet), access);
+    my::advise_region(beta.data(), beta.size() * sizeof(EdgeSet), access);
+    my::advise_region(gamma.data(), gamma.size() * sizeof(EdgeSet), access);
+}
 
-    while (!_change_history.empty())
+void DynGraph::_rewind(std::size_t mark)
+{
+    std::vector<my::StateVector<EdgeSet> *> s = {&alpha, &beta, &gamma};
+
+    while (_change_history.size() > mark)
     {
         // WARNING: move here is necessary to avoid popping and destroying the reference while we use it below
         ChangeRecord record = std::move(_change_history.top());
@@ -127,6 +234,10 @@ void DynGraph::_rewind()
             gamma[record.v] = std::move(beta[record.v]);
             break;
 
+        case ChangeRecordType::ComponentRelabel:
+            _components[record.v] = record.primary_set;
+            break;
+
         default:
             continue;
         }
@@ -139,76 +250,1034 @@ void DynGraph::dyn_remove_edge(Edge e)
     Vertex u = source(e, _G);
     Vertex v = target(e, _G);
 
+    if (_edge_index_built)
+    {
+        // drop exactly this edge, a parallel one may remain
+        auto range = _edge_index.equal_range(_edge_key(u, v));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (&it->second.at_lo->get_property() == e.get_property())
+            {
+                _edge_index.erase(it);
+                break;
+            }
+        }
+    }
+
+    reclaim_state();
     // remove the edge from the graph, the edge is removed from the appropriate EdgeSets inside process B
     remove_edge(e, _G);
 
-    reorg_after_remove(v, u);
+    _reorg_after_remove(v, u);
+}
+
+bool DynGraph::dyn_remove_edge(Vertex u, Vertex v)
+{
+    reclaim_state();
+    if (!_edge_index_built)
+    {
+        build_edge_index();
+    }
+    auto found = _edge_index.find(_edge_key(u, v));
+    if (found == _edge_index.end())
+    {
+        return false;
+    }
+
+    // what remove_edge does, without searching the out-edge lists for the two halves of the edge
+    EdgeSlot slot = found->second;
+    _edge_index.erase(found);
+    auto edge_node = slot.at_lo->get_iter();
+    _G.out_edge_list(std::min(u, v)).erase(slot.at_lo);
+    _G.out_edge_list(std::max(u, v)).erase(slot.at_hi);
+    _G.m_edges.erase(edge_node);
+
+    // same order of the endpoints as dyn_remove_edge(edge(u, v, G).first)
+    _reorg_after_remove(v, u);
+    return true;
+}
+
+void DynGraph::build_edge_index()
+{
+    reclaim_state();
+    _edge_index.clear();
+    _edge_index.reserve(num_edges(_G));
+    // the vertices are visited in increasing order, so the first half found of every edge is the one at its smaller endpoint
+    // (or the first of the two copies of a self loop), matched with the other half through the node of the global edge list
+    std::unordered_map<const void *, OutEdgeList::iterator> first_half;
+    for (Vertex w = 0; w < num_vertices(_G); ++w)
+    {
+        OutEdgeList &out = _G.out_edge_list(w);
+        for (auto it = out.begin(); it != out.end(); ++it)
+        {
+            const void *node = &(*it->get_iter());
+            auto other = first_half.find(node);
+            if (other == first_half.end())
+            {
+                first_half.emplace(node, it);
+                continue;
+            }
+            EdgeSlot slot = {other->second, it};
+            _edge_index.emplace(_edge_key(w, it->get_target()), slot);
+            first_half.erase(other);
+        }
+    }
+    assert(first_half.empty() && _edge_index.size() == num_edges(_G));
+    _edge_index_built = true;
+}
+
+std::uint64_t DynGraph::_edge_key(Vertex u, Vertex v)
+{
+    // undirected, the smaller endpoint first
+    if (v < u)
+    {
+        std::swap(u, v);
+    }
+    return static_cast<std::uint64_t>(u) * num_vertices(_G) + v;
+}
+
+void DynGraph::_unindex_removed(Vertex v, Vertex u)
+{
+    std::uint64_t key = _edge_key(v, u);
+    if (_edge_index.count(key) <= 1)
+    {
+        _edge_index.erase(key);
+        return;
+    }
+
+    // one of several parallel edges is gone and its slot now dangles, index the remaining ones again
+    _edge_index.erase(key);
+    Vertex lo = std::min(u, v);
+    Vertex hi = std::max(u, v);
+    OutEdgeList &out_lo = _G.out_edge_list(lo);
+    OutEdgeList &out_hi = _G.out_edge_list(hi);
+    for (auto it = out_lo.begin(); it != out_lo.end(); ++it)
+    {
+        if (it->get_target() != hi)
+        {
+            continue;
+        }
+        for (auto other = out_hi.begin(); other != out_hi.end(); ++other)
+        {
+            // a self loop has both halves in the same list, the second one comes after the first
+            if (other != it && other->get_iter() == it->get_iter())
+            {
+                if (lo != hi || std::distance(out_lo.begin(), it) < std::distance(out_lo.begin(), other))
+                {
+                    EdgeSlot slot = {it, other};
+                    _edge_index.emplace(key, slot);
+                }
+                break;
+            }
+        }
+    }
 }
 
 void DynGraph::reorg_after_remove(Vertex v, Vertex u)
+{
+    if (_edge_index_built)
+    {
+        _unindex_removed(v, u);
+    }
+    _reorg_after_remove(v, u);
+}
+
+void DynGraph::_reorg_after_remove(Vertex v, Vertex u)
+{
+    std::uint64_t t1 = my::clock_ticks();
+    std::size_t small_size = _reorg(v, u);
+    std::uint64_t t2 = my::clock_ticks();
+    _last_reorg_ticks = t2 - t1;
+    if (_track_latency)
+    {
+        _reorg_latency.record(_last_reorg_ticks);
+    }
+    if (_trace)
+    {
+        _trace->record_deletion(v, u, _components[v] != _components[u]);
+    }
+    if (_phases)
+    {
+        _phases->complete("reorg", my::PhaseTracer::Deletions, t1, t2,
+                          {{"v", static_cast<long long>(v)},
+                           {"u", static_cast<long long>(u)},
+                           {"breaks", small_size > 0},
+                           {"small_component", static_cast<long long>(small_size)}});
+    }
+    if (_compact_min_load_factor > 0.0 && _compact_per_deletion > 0)
+    {
+        // after the deletion has been timed, and without malloc_trim, which walks the whole heap. No iterator into the sets
+        // is alive between deletions.
+        _compact(_compact_per_deletion, false);
+    }
+}
+
+std::size_t DynGraph::_reorg(Vertex v, Vertex u)
+{
+    assert(_live_forks == 0 && "The state is shared with forks.");
+    if (_rebuild_ready)
+    {
+        // the rebuilt structure has caught up, continue from it
+        finish_background_rebuild();
+    }
+
+#ifdef DYN_COUNTERS
+    _last_counters.reset();
+#endif
+
+    std::size_t level_bumps = 0;
+    std::size_t small_size = (_engine == ReorgEngine::Coroutine) ? _reorg_coroutine(v, u, level_bumps)
+                                                                 : _reorg_state_machine(v, u, level_bumps);
+
+#ifdef DYN_COUNTERS
+    // the records still on the stack were not rewound, the rewound ones have been counted by _split_component
+    _last_counters.records_pushed += _change_history.size();
+    _last_counters.small_component_size = small_size;
+    _last_counters.deletions = 1;
+    _total_counters += _last_counters;
+#endif
+
+    // after each run, empty change history
+    // NOTE: this takes O(N) to delete all elements, only adds a constant to the total run complexity
+    _change_log_peak = std::max(_change_log_peak, _change_history.size());
+    if (!_bumped.empty())
+    {
+        // a split rewinds every level increase, otherwise they were all kept
+        if (small_size == 0)
+        {
+            _publisher->begin();
+            for (auto it = _bumped.begin(); it != _bumped.end(); ++it)
+            {
+                _publisher->set_level(*it, _levels[*it]);
+            }
+            _publisher->end();
+        }
+        _bumped.clear();
+    }
+    if (!_change_history.empty())
+    {
+        _change_history = std::stack<ChangeRecord>();
+    }
+
+    _scheduler.record(small_size > 0, small_size);
+
+    _level_sum += level_bumps;
+    ++_deletions_since_init;
+    ++_deletions;
+    ++_compact_dirty;
+
+    if (_rebuild_thread.joinable())
+    {
+        // a rebuild is running, it will replay this deletion before being swapped in
+        std::lock_guard<std::mutex> lock(_rebuild_mutex);
+        _rebuild_pending.push_back(std::make_pair(u, v));
+    }
+    else if (_reroot_due())
+    {
+        // the tree has become too deep, a fresh BFS is cheaper to maintain from here on
+        if (_reroot_background)
+        {
+            start_background_rebuild(_reroot_strategy);
+        }
+        else
+        {
+            init(_reroot_strategy);
+        }
+    }
+    if (_publisher)
+    {
+        _publisher->set_deletions(_deletions);
+    }
+    return small_size;
+}
+
+std::size_t DynGraph::_reorg_state_machine(Vertex v, Vertex u, std::size_t &level_bumps)
 {
     // initialize the "parallel" processes
-    my::StepDetectBreak procA(_G, u, v);
-    my::StepDetectNotBreak procB(_levels, alpha, beta, gamma, _change_history, u, v);
+    my::StepDetectBreak procA(_G, u, v, _scheduler.branch_quantum(), &_last_counters);
+    my::StepDetectNotBreak procB(_levels, alpha, beta, gamma, _change_history, u, v, &_last_counters, _bumped_sink());
 
     bool record_changes = true;
+    int steps_a = _scheduler.steps_a();
+    int steps_b = _scheduler.steps_b();
 
     // Execution halts if:
     // 1) Process B halts. Result: no component breaks
     // 2) Process A halts and has detected component break. Result: component breaks
-    // In other cases, if A has finished but no component breaks, and B is still running, A is skipped
+    // In other cases, if A has finished but no component breaks, and B is still running, A is skipped.
+    // Each process runs for the number of steps given by the scheduler before handing over to the other.
     while (procB.state != my::StepDetectNotBreakState::Finished)
     {
-        if (procA.state != my::StepDetectBreakState::Finished)
+        std::uint64_t t1 = _phases ? my::clock_ticks() : 0;
+        int i = 0;
+        for (; i < steps_a && procA.state != my::StepDetectBreakState::Finished; ++i)
         {
             procA.advance();
         }
-        else
+        if (_phases && i > 0)
+        {
+            _phases->complete("A", my::PhaseTracer::ProcessA, t1, my::clock_ticks(), {{"steps", i}});
+        }
+
+        if (procA.state == my::StepDetectBreakState::Finished)
         {
             if (procA.component_breaks)
             {
                 // here process A has detected a component breaking
-                // we need to update components, rewind process B changes
-                ++_component_max_idx;
-                for (auto it = procA.small_component.begin(); it != procA.small_component.end(); ++it)
-                {
-                    _components[*it] = _component_max_idx;
-                }
-                _rewind();
+                _split_component(procA.small_component);
+                return procA.small_component.size();
+            }
+            // process A has finished and detected that no component breaks
+            // we have to let process B continue until it detects that, so that the BFS structure remains
+            // however, we can stop recording changes to save space, unless the deletion is speculative and will be undone
+            record_changes = _speculating;
+        }
+
+        t1 = _phases ? my::clock_ticks() : 0;
+        for (i = 0; i < steps_b && procB.state != my::StepDetectNotBreakState::Finished; ++i)
+        {
+            procB.advance(record_changes);
+        }
+        if (_phases)
+        {
+            _phases->complete("B", my::PhaseTracer::ProcessB, t1, my::clock_ticks(),
+                              {{"steps", i}, {"records", static_cast<long long>(_change_history.size())}});
+        }
+    }
+    level_bumps = procB.level_bumps;
+    return 0;
+}
+
+std::size_t DynGraph::_reorg_coroutine(Vertex v, Vertex u, std::size_t &level_bumps)
+{
+    // record_changes is read by process B on every step, so it has to outlive the coroutine
+    bool record_changes = true;
+    my::BreakOutcome outcomeA;
+    my::StepTask procA = my::coro_detect_break(_G, u, v, outcomeA, _scheduler.branch_quantum(), _scheduler.steps_a(),
+                                               &_last_counters);
+    my::StepTask procB = my::coro_detect_not_break(_levels, alpha, beta, gamma, _change_history, u, v, record_changes,
+                                                   level_bumps, _scheduler.steps_b(), &_last_counters, _bumped_sink());
+
+    // same halting conditions as the state machine engine, one advance runs a whole scheduler turn
+    while (!procB.finished())
+    {
+        std::uint64_t t1 = _phases ? my::clock_ticks() : 0;
+        bool ran_a = !procA.finished();
+        procA.advance();
+        if (_phases && ran_a)
+        {
+            _phases->complete("A", my::PhaseTracer::ProcessA, t1, my::clock_ticks());
+        }
+
+        if (procA.finished())
+        {
+            if (outcomeA.component_breaks)
+            {
+                _split_component(outcomeA.small_component);
+                // the level increases have been rewound
+                level_bumps = 0;
+                return outcomeA.small_component.size();
+            }
+            record_changes = _speculating;
+        }
 
+        t1 = _phases ? my::clock_ticks() : 0;
+        procB.advance();
+        if (_phases)
+        {
+            _phases->complete("B", my::PhaseTracer::ProcessB, t1, my::clock_ticks(),
+                              {{"records", static_cast<long long>(_change_history.size())}});
+        }
+    }
+    return 0;
+}
+
+void DynGraph::_split_component(const std::list<Vertex> &small_component)
+{
+    if (_speculating)
+    {
+        // only the changes of this deletion are undone now, the relabeling is recorded with the earlier deletions so that
+        // would_disconnect undoes all of them at the end
+        _rewind(_speculation_mark);
+        ++_component_max_idx;
+        for (auto it = small_component.begin(); it != small_component.end(); ++it)
+        {
+            _change_history.push(ChangeRecord(ChangeRecordType::ComponentRelabel, *it, *it, _components[*it]));
+            _components[*it] = _component_max_idx;
+        }
+        return;
+    }
+
+    // we need to update components, rewind process B changes
+    ++_component_max_idx;
+    for (auto it = small_component.begin(); it != small_component.end(); ++it)
+    {
+        _components[*it] = _component_max_idx;
+    }
+    if (_publisher)
+    {
+        _publisher->begin();
+        for (auto it = small_component.begin(); it != small_component.end(); ++it)
+        {
+            _publisher->set_component(*it, _component_max_idx);
+        }
+        _publisher->end();
+    }
+#ifdef DYN_COUNTERS
+    _last_counters.records_pushed += _change_history.size();
+    _last_counters.records_rewound += _change_history.size();
+#endif
+    _change_log_peak = std::max(_change_log_peak, _change_history.size());
+    if (!_phases)
+    {
+        _rewind();
+        return;
+    }
+    std::size_t records = _change_history.size();
+    std::uint64_t t1 = my::clock_ticks();
+    _rewind();
+    _phases->complete("rewind", my::PhaseTracer::Deletions, t1, my::clock_ticks(),
+                      {{"records", static_cast<long long>(records)},
+                       {"small_component", static_cast<long long>(small_component.size())}});
+}
+
+bool DynGraph::query_is_connected(Vertex v, Vertex u)
+{
+    if (_installed_fork != nullptr)
+    {
+        reclaim_state();
+    }
+    if (!_track_latency)
+    {
+        return _components[v] == _components[u];
+    }
+    std::uint64_t t1 = my::clock_ticks();
+    bool connected = _components[v] == _components[u];
+    _query_latency.record(my::clock_ticks() - t1);
+    return connected;
+}
+
+bool DynGraph::would_disconnect(Edge e)
+{
+    std::vector<Edge> edges(1, e);
+    return would_disconnect(edges, source(e, _G), target(e, _G));
+}
+
+bool DynGraph::would_disconnect(const std::vector<Edge> &edges, Vertex u, Vertex v)
+{
+    reclaim_state();
+    assert(_change_history.empty());
+    int component_max_idx = _component_max_idx;
+    my::ReorgCounters counters = _last_counters;
+    std::vector<MaskedEdge> masked;
+    // the masked edges are never moved, their lists hold the nodes taken out of the graph
+    masked.reserve(edges.size());
+
+    _speculating = true;
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+    {
+        Vertex a = source(*it, _G);
+        Vertex b = target(*it, _G);
+        if (a == b)
+        {
+            // a self loop never disconnects anything
+            continue;
+        }
+        masked.emplace_back();
+        _mask_edge(*it, masked.back());
+        // same order of the endpoints as dyn_remove_edge
+        _speculate(b, a);
+    }
+    bool disconnected = _components[u] != _components[v];
+
+    // the history holds every change since the first deletion, the edges go back in the reverse order they were masked in
+    _change_log_peak = std::max(_change_log_peak, _change_history.size());
+    _rewind();
+    _speculating = false;
+    _component_max_idx = component_max_idx;
+    for (auto it = masked.rbegin(); it != masked.rend(); ++it)
+    {
+        _unmask_edge(*it);
+    }
+    _last_counters = counters;
+    return disconnected;
+}
+
+void DynGraph::_mask_edge(Edge e, MaskedEdge &masked)
+{
+    masked.lo = std::min(source(e, _G), target(e, _G));
+    masked.hi = std::max(source(e, _G), target(e, _G));
+    OutEdgeList &out_lo = _G.out_edge_list(masked.lo);
+    OutEdgeList &out_hi = _G.out_edge_list(masked.hi);
+    OutEdgeList::iterator at_lo = out_lo.end();
+    OutEdgeList::iterator at_hi = out_hi.end();
+    if (_edge_index_built)
+    {
+        auto range = _edge_index.equal_range(_edge_key(masked.lo, masked.hi));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (&it->second.at_lo->get_property() == e.get_property())
+            {
+                at_lo = it->second.at_lo;
+                at_hi = it->second.at_hi;
+                break;
+            }
+        }
+    }
+    else
+    {
+        // the half at the smaller endpoint is this very edge, the other half points to the same node of the edge list
+        for (auto it = out_lo.begin(); it != out_lo.end(); ++it)
+        {
+            if (&it->get_property() == e.get_property())
+            {
+                at_lo = it;
                 break;
             }
-            else
+        }
+        for (auto it = out_hi.begin(); at_lo != out_lo.end() && it != out_hi.end(); ++it)
+        {
+            if (it->get_iter() == at_lo->get_iter())
             {
-                // process A has finished and detected that no component breaks
-                // we have to let process B continue until it detects that, so that the BFS structure remains
-                // however, we can stop recording changes to save space
-                record_changes = false;
+                at_hi = it;
+                break;
             }
         }
+    }
+    assert(at_lo != out_lo.end() && at_hi != out_hi.end() && "The edge is not in the graph.");
+
+    // the nodes are spliced out rather than erased, so every descriptor and index entry stays valid
+    auto stored = at_lo->get_iter();
+    masked.next_lo = std::next(at_lo);
+    masked.next_hi = std::next(at_hi);
+    masked.next_stored = std::next(stored);
+    masked.half_lo.splice(masked.half_lo.end(), out_lo, at_lo);
+    masked.half_hi.splice(masked.half_hi.end(), out_hi, at_hi);
+    masked.stored.splice(masked.stored.end(), _G.m_edges, stored);
+}
+
+void DynGraph::_unmask_edge(MaskedEdge &masked)
+{
+    _G.m_edges.splice(masked.next_stored, masked.stored);
+    _G.out_edge_list(masked.hi).splice(masked.next_hi, masked.half_hi);
+    _G.out_edge_list(masked.lo).splice(masked.next_lo, masked.half_lo);
+}
 
-        procB.advance(record_changes);
+void DynGraph::_speculate(Vertex v, Vertex u)
+{
+    // Process B takes the edge out of the sets of its endpoints without a record, a deleted edge never comes back. This one
+    // does, so the removals are recorded here, in the sets the edge is in given the levels of its endpoints.
+    if (_levels[u] == _levels[v])
+    {
+        _change_history.push(ChangeRecord(ChangeRecordType::Remove, u, v, 1));
+        _change_history.push(ChangeRecord(ChangeRecordType::Remove, v, u, 1));
     }
-    // after each run, empty change history
-    // NOTE: this takes O(N) to delete all elements, only adds a constant to the total run complexity
-    if (!_change_history.empty())
+    else
     {
-        _change_history = std::stack<ChangeRecord>();
+        Vertex upper = (_levels[u] < _levels[v]) ? u : v;
+        Vertex lower = (upper == u) ? v : u;
+        _change_history.push(ChangeRecord(ChangeRecordType::Remove, upper, lower, 2));
+        _change_history.push(ChangeRecord(ChangeRecordType::Remove, lower, upper, 0));
+    }
+    _speculation_mark = _change_history.size();
+
+    std::size_t level_bumps = 0;
+    if (_engine == ReorgEngine::Coroutine)
+    {
+        _reorg_coroutine(v, u, level_bumps);
+    }
+    else
+    {
+        _reorg_state_machine(v, u, level_bumps);
     }
 }
 
-bool DynGraph::query_is_connected(Vertex v, Vertex u)
+void DynGraph::_history_vertices(std::vector<Vertex> &vertices)
+{
+    // a stack cannot be walked, the records are moved out and back in the same order
+    std::vector<ChangeRecord> records;
+    records.reserve(_change_history.size());
+    while (!_change_history.empty())
+    {
+        vertices.push_back(_change_history.top().v);
+        records.push_back(std::move(_change_history.top()));
+        _change_history.pop();
+    }
+    for (auto it = records.rbegin(); it != records.rend(); ++it)
+    {
+        _change_history.push(std::move(*it));
+    }
+}
+
+void DynGraph::reclaim_state()
+{
+    if (_installed_fork != nullptr)
+    {
+        _installed_fork->_uninstall();
+    }
+}
+
+std::vector<Vertex> DynGraph::connecting_path(Vertex u, Vertex v)
+{
+    reclaim_state();
+    std::vector<Vertex> path;
+    if (_components[u] != _components[v])
+    {
+        return path;
+    }
+
+    // every step goes one level up from the deeper of the two ends, which meet at their closest common ancestor. Only
+    // the top vertex of the component has no parent, so at the same level the other end moves.
+    std::vector<Vertex> from_v;
+    Vertex a = u;
+    Vertex b = v;
+    path.push_back(a);
+    from_v.push_back(b);
+    while (a != b)
+    {
+        if (_levels[a] > _levels[b] || (_levels[a] == _levels[b] && !alpha[a].empty()))
+        {
+            a = my::tree_parent(alpha, a);
+            path.push_back(a);
+        }
+        else
+        {
+            b = my::tree_parent(alpha, b);
+            from_v.push_back(b);
+        }
+    }
+    // the common ancestor ends both halves
+    path.insert(path.end(), from_v.rbegin() + 1, from_v.rend());
+    return path;
+}
+
+SpanningForest DynGraph::spanning_forest()
+{
+    reclaim_state();
+    return SpanningForest(alpha);
+}
+
+DynGraphFork DynGraph::fork()
 {
-    return _components[v] == _components[u];
+    // a fork installs its own components between its deletions
+    assert(!_async_attached && "The components are read by an AsyncDynGraph.");
+    reclaim_state();
+    return DynGraphFork(*this);
 }
 
 bool DynGraph::query_is_connected(Edge e)
 {
-    return _components[source(e, _G)] == _components[target(e, _G)];
+    return query_is_connected(source(e, _G), target(e, _G));
+}
+
+
+const my::ReorgCounters &DynGraph::last_counters()
+{
+    return _last_counters;
+}
+
+const my::ReorgCounters &DynGraph::total_counters()
+{
+    return _total_counters;
+}
+
+void DynGraph::reset_counters()
+{
+    _last_counters.reset();
+    _total_counters.reset();
+}
+
+my::LatencyHistogram DynGraph::reorg_latency()
+{
+    return _reorg_latency;
+}
+
+my::LatencyHistogram DynGraph::query_latency()
+{
+    return _query_latency;
+}
+
+std::uint64_t DynGraph::last_reorg_ticks()
+{
+    return _last_reorg_ticks;
+}
+
+void DynGraph::reset_latency()
+{
+    _reorg_latency.reset();
+    _query_latency.reset();
+}
+
+void DynGraph::set_latency_tracking(bool enabled)
+{
+    _track_latency = enabled;
+}
+
+bool DynGraph::start_trace(const std::string &path)
+{
+    // a background rebuild is swapped in whenever its thread catches up, and a random root is drawn from the clock
+    if (_rebuild_thread.joinable() ||
+        (_reroot_drift_factor > 0.0 && (_reroot_background || _reroot_strategy == RootStrategy::Random)))
+    {
+        return false;
+    }
+    reclaim_state();
+    _trace.reset(new my::TraceWriter(path, _G, _r, static_cast<std::uint64_t>(_engine), trace_settings()));
+    if (!_trace->is_open())
+    {
+        _trace.reset();
+        return false;
+    }
+    return true;
+}
+
+void DynGraph::stop_trace()
+{
+    // closing the stream flushes the remaining records
+    _trace.reset();
+}
+
+my::TraceSettings DynGraph::trace_settings()
+{
+    my::TraceSettings settings;
+    settings.scheduler = _scheduler;
+    settings.reroot_drift_factor = _reroot_drift_factor;
+    settings.reroot_min_deletions = _reroot_min_deletions;
+    settings.reroot_strategy = static_cast<std::uint64_t>(_reroot_strategy);
+    settings.compact_min_load_factor = _compact_min_load_factor;
+    settings.compact_per_deletion = _compact_per_deletion;
+    settings.compact_cursor = _compact_cursor;
+    return settings;
+}
+
+void DynGraph::apply_trace_settings(const my::TraceSettings &settings)
+{
+    assert(settings.compact_cursor == 0 || settings.compact_cursor < _levels.size());
+    _scheduler = settings.scheduler;
+    set_reroot_policy(settings.reroot_drift_factor, settings.reroot_min_deletions,
+                      static_cast<RootStrategy>(settings.reroot_strategy), false);
+    _compact_min_load_factor = settings.compact_min_load_factor;
+    _compact_per_deletion = settings.compact_per_deletion;
+    _compact_cursor = settings.compact_cursor;
+}
+
+bool DynGraph::start_phase_trace(const std::string &path, std::size_t max_events)
+{
+    _phases.reset(new my::PhaseTracer(path, max_events));
+    if (!_phases->is_open())
+    {
+        _phases.reset();
+        return false;
+    }
+    return true;
+}
+
+bool DynGraph::stop_phase_trace()
+{
+    if (!_phases)
+    {
+        return false;
+    }
+    bool ok = _phases->close();
+    _phases.reset();
+    return ok;
+}
+
+bool DynGraph::start_publishing(const std::string &name, bool with_levels, std::string &error)
+{
+    reclaim_state();
+    std::unique_ptr<my::SharedComponentsWriter> publisher(new my::SharedComponentsWriter());
+    if (!publisher->create(name, _levels.size(), with_levels, error))
+    {
+        return false;
+    }
+    _publisher = std::move(publisher);
+    _publish_all();
+    return true;
 }
 
+void DynGraph::stop_publishing()
+{
+    _publisher.reset();
+}
+
+std::vector<Vertex> *DynGraph::_bumped_sink()
+{
+    return (_publisher && _publisher->has_levels() && !_speculating) ? &_bumped : nullptr;
+}
+
+void DynGraph::_publish_all()
+{
+    if (!_publisher)
+    {
+        return;
+    }
+    _publisher->publish_all(_components.data(), _levels.data());
+    _publisher->set_deletions(_deletions);
+}
+
+my::MemoryUsage DynGraph::memory_usage()
+{
+    reclaim_state();
+    my::MemoryUsage usage;
+    // the graph keeps a vector of vertices, a list of out-edges per vertex, holding both directions of every undirected edge,
+    // and a global list of edges
+    std::size_t out_edge_node = my::allocation_bytes(2 * sizeof(void *) + sizeof(Graph::StoredEdge));
+    std::size_t edge_node = my::allocation_bytes(2 * sizeof(void *) + sizeof(Graph::EdgeContainer::value_type));
+    usage.graph = my::allocation_bytes(num_vertices(_G) * sizeof(Graph::stored_vertex));
+    VertexIterator vi, viend;
+    for (tie(vi, viend) = vertices(_G); vi != viend; ++vi)
+    {
+        usage.graph += out_degree(*vi, _G) * out_edge_node;
+    }
+    usage.graph += num_edges(_G) * edge_node;
+
+    usage.levels = my::state_allocation_bytes(_memory, _levels.capacity() * sizeof(int));
+    usage.components = my::state_allocation_bytes(_memory, _components.capacity() * sizeof(int));
+    my::StateVector<EdgeSet> *sets[3] = {&alpha, &beta, &gamma};
+    std::size_t *sizes[3] = {&usage.alpha, &usage.beta, &usage.gamma};
+    for (int i = 0; i < 3; ++i)
+    {
+        *sizes[i] = my::state_allocation_bytes(_memory, sets[i]->capacity() * sizeof(EdgeSet));
+        for (auto it = sets[i]->begin(); it != sets[i]->end(); ++it)
+        {
+            *sizes[i] += it->memory_usage();
+        }
+    }
+    // the records are stored in a deque, the sets they move are counted where they came from
+    usage.change_log_peak = _change_log_peak * sizeof(ChangeRecord);
+    // a node holds the next pointer, the key and the slot, the hash of an integer is not cached
+    usage.edge_index = 0;
+    if (_edge_index_built)
+    {
+        usage.edge_index = _edge_index.bucket_count() * sizeof(void *) +
+                           _edge_index.size() * my::allocation_bytes(sizeof(void *) + sizeof(std::uint64_t) + sizeof(EdgeSlot));
+    }
+    return usage;
+}
+
+const my::MemoryPolicy &DynGraph::memory_policy()
+{
+    return _memory;
+}
 
 Vertex DynGraph::get_root()
 {
     return _r;
+}
+
+void DynGraph::set_scheduler(const my::StepScheduler &scheduler)
+{
+    _scheduler = scheduler;
+}
+
+const my::StepScheduler &DynGraph::get_scheduler()
+{
+    return _scheduler;
+}
+
+void DynGraph::set_engine(ReorgEngine engine)
+{
+    _engine = engine;
+}
+
+void DynGraph::set_reroot_policy(double drift_factor, std::size_t min_deletions, RootStrategy strategy, bool background)
+{
+    assert((drift_factor <= 0.0 || !_async_attached) && "The components are read by an AsyncDynGraph.");
+    _reroot_drift_factor = drift_factor;
+    _reroot_min_deletions = min_deletions;
+    _reroot_strategy = strategy;
+    _reroot_background = background;
+}
+
+void DynGraph::set_compaction_policy(double min_load_factor, std::size_t vertices_per_deletion, std::size_t trim_bytes)
+{
+    _compact_min_load_factor = min_load_factor;
+    _compact_per_deletion = vertices_per_deletion;
+    _compact_trim_bytes = trim_bytes;
+}
+
+std::size_t DynGraph::compact_edge_sets(std::size_t vertices)
+{
+    reclaim_state();
+    return _compact(vertices, true);
+}
+
+std::size_t DynGraph::_compact(std::size_t vertices, bool trim)
+{
+    std::size_t released = 0;
+    std::size_t n = _levels.size();
+    for (std::size_t i = 0; i < vertices && n > 0; ++i)
+    {
+        if (_compact_cursor == 0)
+        {
+            // a new pass covers the deletions made before it
+            _compact_dirty = 0;
+        }
+        EdgeSet *sets[3] = {&alpha[_compact_cursor], &beta[_compact_cursor], &gamma[_compact_cursor]};
+        for (int s = 0; s < 3; ++s)
+        {
+            std::size_t bytes = sets[s]->shrink(_compact_min_load_factor);
+            if (bytes > 0)
+            {
+                ++_compaction_stats.sets_shrunk;
+                released += bytes;
+                _compact_sweep_bytes += bytes;
+            }
+        }
+
+        if (++_compact_cursor == n)
+        {
+            // a full pass is done. The freed chunks are scattered over the heap and glibc only gives back its top by itself.
+            if (_compact_sweep_bytes >= _compact_trim_bytes)
+            {
+                _trim_pending = true;
+            }
+            ++_compaction_stats.sweeps;
+            _compact_cursor = 0;
+            _compact_sweep_bytes = 0;
+            _compact_pass_deletions = _compact_dirty;
+            _compact_dirty = 0;
+        }
+    }
+    if (trim && _trim_pending)
+    {
+        malloc_trim(0);
+        ++_compaction_stats.trims;
+        _trim_pending = false;
+    }
+    _compaction_stats.bytes_released += released;
+    return released;
+}
+
+bool DynGraph::compaction_pending()
+{
+    // a pass is pending until it completes, and the sets visited early in the last pass may have drained while it ran. The
+    // trim of a pass made by the deletions waits for the next call to compact_edge_sets.
+    return _compact_min_load_factor > 0.0 &&
+           (_compact_cursor != 0 || _compact_dirty > 0 || _compact_pass_deletions > 0 || _trim_pending);
+}
+
+const my::CompactionStats &DynGraph::compaction_stats()
+{
+    return _compaction_stats;
+}
+
+double DynGraph::average_level()
+{
+    return _levels.empty() ? 0.0 : static_cast<double>(_level_sum) / _levels.size();
+}
+
+bool DynGraph::_reroot_due()
+{
+    if (_reroot_drift_factor <= 0.0 || _deletions_since_init < _reroot_min_deletions)
+    {
+        return false;
+    }
+    // comparing the sums is the same as comparing the averages, the number of vertices does not change
+    return _level_sum > _reroot_drift_factor * std::max(_init_level_sum, 1LL);
+}
+
+bool DynGraph::start_background_rebuild(RootStrategy strategy)
+{
+    assert(!_async_attached && "The components are read by an AsyncDynGraph.");
+    if (_rebuild_thread.joinable())
+    {
+        return false;
+    }
+
+    reclaim_state();
+    // snapshot the edges in the order they were inserted, the rebuild thread must not read _G while deletions modify it
+    std::vector<std::pair<Vertex, Vertex>> edge_list;
+    edge_list.reserve(num_edges(_G));
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(_G); ei != eiend; ++ei)
+    {
+        edge_list.push_back(std::make_pair(source(*ei, _G), target(*ei, _G)));
+    }
+
+    _rebuild_ready = false;
+    _rebuild_pending.clear();
+    _rebuild_thread = std::thread(&DynGraph::_rebuild, this, num_vertices(_G), std::move(edge_list), strategy);
+    return true;
+}
+
+bool DynGraph::finish_background_rebuild(bool wait)
+{
+    if (!_rebuild_thread.joinable() || (!wait && !_rebuild_ready))
+    {
+        return false;
+    }
+    _rebuild_thread.join();
+
+    // replay the deletions that arrived after the rebuild thread caught up, usually none or very few
+    _replay_into_shadow(_rebuild_pending);
+    _rebuild_pending.clear();
+
+    _swap_structure(*_shadow);
+    _publish_all();
+    _shadow.reset();
+    _shadow_graph.reset();
+    _rebuild_ready = false;
+    return true;
+}
+
+bool DynGraph::rebuild_in_progress()
+{
+    return _rebuild_thread.joinable();
+}
+
+void DynGraph::_rebuild(std::size_t n, std::vector<std::pair<Vertex, Vertex>> edge_list, RootStrategy strategy)
+{
+    // the shadow graph has the same vertex ids, so the rebuilt structure is valid for _G
+    _shadow_graph = std::unique_ptr<Graph>(new Graph(n));
+    for (auto it = edge_list.begin(); it != edge_list.end(); ++it)
+    {
+        add_edge(it->first, it->second, *_shadow_graph);
+    }
+    _shadow = std::unique_ptr<DynGraph>(new DynGraph(*_shadow_graph, strategy, _memory));
+
+    // catch up with the deletions that happened since the snapshot
+    while (true)
+    {
+        std::vector<std::pair<Vertex, Vertex>> deletions;
+        {
+            std::lock_guard<std::mutex> lock(_rebuild_mutex);
+            if (_rebuild_pending.empty())
+            {
+                _rebuild_ready = true;
+                return;
+            }
+            deletions.swap(_rebuild_pending);
+        }
+        _replay_into_shadow(deletions);
+    }
+}
+
+void DynGraph::_replay_into_shadow(const std::vector<std::pair<Vertex, Vertex>> &deletions)
+{
+    for (auto it = deletions.begin(); it != deletions.end(); ++it)
+    {
+        // a scan of the out-edges of one end, the endpoint index would cost a pass over the whole shadow graph and as much
+        // memory as its edge list for a handful of deletions
+        std::pair<Edge, bool> found = edge(it->first, it->second, *_shadow_graph);
+        assert(found.second && "Deletion replayed into the rebuilt structure is not in its graph.");
+        _shadow->dyn_remove_edge(found.first);
+    }
+}
+
+void DynGraph::_swap_structure(DynGraph &other)
+{
+    // the sets take the arena of their tables along
+    std::swap(_edge_arena, other._edge_arena);
+    std::swap(_levels, other._levels);
+    std::swap(_components, other._components);
+    std::swap(alpha, other.alpha);
+    std::swap(beta, other.beta);
+    std::swap(gamma, other.gamma);
+    std::swap(_r, other._r);
+    std::swap(_component_max_idx, other._component_max_idx);
+    std::swap(_level_sum, other._level_sum);
+    std::swap(_init_level_sum, other._init_level_sum);
+    std::swap(_deletions_since_init, other._deletions_since_init);
 }
\ No newline at end of file
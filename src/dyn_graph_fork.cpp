@@ -0,0 +1,242 @@
+#include "dyn_graph_fork.hpp"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using namespace boost;
+
+DynGraphFork::DynGraphFork(DynGraph &base) : _base(base), _component_max_idx(base._component_max_idx)
+{
+    ++_base._live_forks;
+}
+
+DynGraphFork::DynGraphFork(const DynGraphFork &other)
+    : _base(other._base), _deleted(other._deleted), _deleted_properties(other._deleted_properties),
+      _component_max_idx(other._component_max_idx)
+{
+    // while other is in place its state is in the arrays of the DynGraph, and its own members hold the one of the DynGraph
+    DynGraph &DG = _base;
+    bool installed = DG._installed_fork == &other;
+    if (installed)
+    {
+        _component_max_idx = DG._component_max_idx;
+    }
+    _touched.reserve(other._touched.size());
+    for (auto it = other._touched.begin(); it != other._touched.end(); ++it)
+    {
+        Vertex w = it->first;
+        const VertexState &state = it->second;
+        if (installed)
+        {
+            _touched.emplace(w, VertexState{DG._levels[w], DG._components[w], DG.alpha[w].copy(), DG.beta[w].copy(),
+                                            DG.gamma[w].copy()});
+        }
+        else
+        {
+            _touched.emplace(w, VertexState{state.level, state.component, state.alpha.copy(), state.beta.copy(),
+                                            state.gamma.copy()});
+        }
+    }
+    ++_base._live_forks;
+}
+
+DynGraphFork::DynGraphFork(DynGraphFork &&other)
+    : _base(other._base), _touched(std::move(other._touched)), _deleted(std::move(other._deleted)),
+      _deleted_properties(std::move(other._deleted_properties)), _component_max_idx(other._component_max_idx),
+      _masked(std::move(other._masked))
+{
+    if (_base._installed_fork == &other)
+    {
+        _base._installed_fork = this;
+    }
+    // other is still counted until it is destroyed
+    ++_base._live_forks;
+}
+
+DynGraphFork::~DynGraphFork()
+{
+    if (_base._installed_fork == this)
+    {
+        _uninstall();
+    }
+    --_base._live_forks;
+}
+
+DynGraphFork DynGraphFork::fork()
+{
+    return DynGraphFork(*this);
+}
+
+void DynGraphFork::dyn_remove_edge(Edge e)
+{
+    DynGraph &DG = _base;
+    assert(_deleted_properties.count(e.get_property()) == 0 && "The edge has already been deleted in this fork.");
+    assert(DG._change_history.empty());
+    Vertex u = source(e, DG._G);
+    Vertex v = target(e, DG._G);
+    _install();
+    _deleted.push_back(e);
+    _deleted_properties.insert(e.get_property());
+
+    my::ReorgCounters counters = DG._last_counters;
+    if (u != v)
+    {
+        // a self loop does not matter to the scans of Process A and is left in place
+        _masked.emplace_back();
+        DG._mask_edge(e, _masked.back());
+    }
+    DG._speculating = true;
+    // same order of the endpoints as DynGraph::dyn_remove_edge
+    DG._speculate(v, u);
+
+    // every vertex the deletion changed has a record, its state is the one of the fork from now on
+    std::vector<Vertex> vertices;
+    DG._history_vertices(vertices);
+    std::unordered_map<Vertex, VertexState> changed;
+    for (auto it = vertices.begin(); it != vertices.end(); ++it)
+    {
+        if (changed.count(*it) == 0)
+        {
+            changed.emplace(*it, VertexState{DG._levels[*it], DG._components[*it], DG.alpha[*it].copy(),
+                                             DG.beta[*it].copy(), DG.gamma[*it].copy()});
+        }
+    }
+
+    // undoing the deletion leaves the previous state of the fork on the vertices it had touched, and the state of the
+    // DynGraph on the others, which the fork keeps from now on
+    DG._change_log_peak = std::max(DG._change_log_peak, DG._change_history.size());
+    DG._rewind();
+    DG._speculating = false;
+    for (auto it = changed.begin(); it != changed.end(); ++it)
+    {
+        Vertex w = it->first;
+        if (_touched.count(w) == 0)
+        {
+            _touched.emplace(w, VertexState{DG._levels[w], DG._components[w], std::move(DG.alpha[w]),
+                                            std::move(DG.beta[w]), std::move(DG.gamma[w])});
+        }
+        DG._levels[w] = it->second.level;
+        DG._components[w] = it->second.component;
+        DG.alpha[w] = std::move(it->second.alpha);
+        DG.beta[w] = std::move(it->second.beta);
+        DG.gamma[w] = std::move(it->second.gamma);
+    }
+    DG._last_counters = counters;
+}
+
+bool DynGraphFork::dyn_remove_edge(Vertex u, Vertex v)
+{
+    // once in place, the graph only holds the self loops among the edges the fork deleted
+    _install();
+    OutEdgeIterator ei, eiend;
+    for (tie(ei, eiend) = out_edges(u, _base._G); ei != eiend; ++ei)
+    {
+        if (target(*ei, _base._G) == v && _deleted_properties.count((*ei).get_property()) == 0)
+        {
+            dyn_remove_edge(*ei);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DynGraphFork::query_is_connected(Vertex u, Vertex v)
+{
+    return component(u) == component(v);
+}
+
+int DynGraphFork::level(Vertex v)
+{
+    const VertexState *state = _state(v);
+    return (state != nullptr) ? state->level : _base._levels[v];
+}
+
+int DynGraphFork::component(Vertex v)
+{
+    const VertexState *state = _state(v);
+    return (state != nullptr) ? state->component : _base._components[v];
+}
+
+std::size_t DynGraphFork::touched_vertices()
+{
+    return _touched.size();
+}
+
+std::size_t DynGraphFork::deleted_edges()
+{
+    return _deleted.size();
+}
+
+void DynGraphFork::_swap_state()
+{
+    for (auto it = _touched.begin(); it != _touched.end(); ++it)
+    {
+        Vertex w = it->first;
+        std::swap(_base._levels[w], it->second.level);
+        std::swap(_base._components[w], it->second.component);
+        std::swap(_base.alpha[w], it->second.alpha);
+        std::swap(_base.beta[w], it->second.beta);
+        std::swap(_base.gamma[w], it->second.gamma);
+    }
+}
+
+void DynGraphFork::_install()
+{
+    DynGraph &DG = _base;
+    if (DG._installed_fork == this)
+    {
+        return;
+    }
+    DG.reclaim_state();
+    _swap_state();
+    std::swap(DG._component_max_idx, _component_max_idx);
+    for (auto it = _deleted.begin(); it != _deleted.end(); ++it)
+    {
+        // self loops are left in place, see dyn_remove_edge
+        if (source(*it, DG._G) != target(*it, DG._G))
+        {
+            _masked.emplace_back();
+            DG._mask_edge(*it, _masked.back());
+        }
+    }
+    DG._installed_fork = this;
+}
+
+void DynGraphFork::_uninstall()
+{
+    DynGraph &DG = _base;
+    assert(DG._installed_fork == this);
+    // the edges go back in the reverse order they were masked in
+    for (auto it = _masked.rbegin(); it != _masked.rend(); ++it)
+    {
+        DG._unmask_edge(*it);
+    }
+    _masked.clear();
+    std::swap(DG._component_max_idx, _component_max_idx);
+    _swap_state();
+    DG._installed_fork = nullptr;
+}
+
+const DynGraphFork::VertexState *DynGraphFork::_state(Vertex v)
+{
+    DynGraph &DG = _base;
+    if (DG._installed_fork == this)
+    {
+        return nullptr;
+    }
+    auto it = _touched.find(v);
+    if (it != _touched.end())
+    {
+        return &it->second;
+    }
+    // the arrays hold the state of another fork on the vertices that one touched, and it holds the one of the DynGraph
+    if (DG._installed_fork != nullptr)
+    {
+        auto other = DG._installed_fork->_touched.find(v);
+        if (other != DG._installed_fork->_touched.end())
+        {
+            return &other->second;
+        }
+    }
+    return nullptr;
+}
@@ -1,19 +1,73 @@
 #include "edge_set.hpp"
+#include "memory_usage.hpp"
 #include <iostream>
+#include <new>
+
+template <class... Args>
+EdgeHashSet *EdgeSet::_make_table(Args &&...args) const
+{
+    my::ArenaAllocator<EdgeHashSet> allocator(my::region_arena(_arena));
+    EdgeHashSet *table = allocator.allocate(1);
+    try
+    {
+        new (table) EdgeHashSet(std::forward<Args>(args)..., EdgeHashSet::allocator_type(allocator));
+    }
+    catch (...)
+    {
+        allocator.deallocate(table, 1);
+        throw;
+    }
+    return table;
+}
+
+void EdgeSet::TableDeleter::operator()(EdgeHashSet *table) const
+{
+    my::ArenaAllocator<EdgeHashSet> allocator(table->get_allocator());
+    table->~EdgeHashSet();
+    allocator.deallocate(table, 1);
+}
 
 void EdgeSet::add_edge(Vertex u, Vertex v)
 {
     Vertex mn = (u < v) ? u : v;
     Vertex mx = (u >= v) ? u : v;
-    _internal_set.insert(std::make_pair(mn, mx));
+    if (_table)
+    {
+        _table->insert(std::make_pair(mn, mx));
+        return;
+    }
+    for (std::uint32_t i = 0; i < _size; ++i)
+    {
+        if (_inline[i].first == mn && _inline[i].second == mx)
+        {
+            return;
+        }
+    }
+    if (_size == INLINE_CAPACITY)
+    {
+        _to_table();
+        _table->insert(std::make_pair(mn, mx));
+        return;
+    }
+    _inline[_size++] = std::make_pair(mn, mx);
 }
 
 bool EdgeSet::contains(Vertex u, Vertex v)
 {
     Vertex mn = (u < v) ? u : v;
     Vertex mx = (u >= v) ? u : v;
-    auto k = _internal_set.find(std::make_pair(mn, mx));
-    return k != _internal_set.end();
+    if (_table)
+    {
+        return _table->find(std::make_pair(mn, mx)) != _table->end();
+    }
+    for (std::uint32_t i = 0; i < _size; ++i)
+    {
+        if (_inline[i].first == mn && _inline[i].second == mx)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool EdgeSet::remove_edge(Vertex u, Vertex v)
@@ -21,33 +75,90 @@ bool EdgeSet::remove_edge(Vertex u, Vertex v)
     Vertex mn = (u < v) ? u : v;
     Vertex mx = (u >= v) ? u : v;
 
-    auto k = _internal_set.find(std::make_pair(mn, mx));
-    if (k == _internal_set.end())
+    if (_table)
     {
-        return false;
+        if (_table->erase(std::make_pair(mn, mx)) == 0)
+        {
+            return false;
+        }
+        if (_table->size() <= SHRINK_SIZE)
+        {
+            _to_inline();
+        }
+        return true;
     }
-
-    if (!contains(u, v))
+    for (std::uint32_t i = 0; i < _size; ++i)
     {
-        return false;
+        if (_inline[i].first == mn && _inline[i].second == mx)
+        {
+            // the order of the edges does not matter, fill the hole with the last one
+            _inline[i] = _inline[--_size];
+            return true;
+        }
     }
+    return false;
+}
 
-    _internal_set.erase(k);
-    return true;
+std::size_t EdgeSet::size()
+{
+    return _table ? _table->size() : _size;
 }
 
-bool EdgeSet::empty()
+bool EdgeSet::is_hashed()
 {
-    return _internal_set.empty();
+    return static_cast<bool>(_table);
 }
 
 void EdgeSet::clear()
 {
-    return _internal_set.clear();
+    _size = 0;
+    _table.reset();
+}
+
+std::size_t EdgeSet::shrink(float min_load_factor)
+{
+    if (!_table)
+    {
+        return 0;
+    }
+    std::size_t before = memory_usage();
+    if (_table->size() <= INLINE_CAPACITY)
+    {
+        _to_inline();
+    }
+    else if (_table->load_factor() < min_load_factor)
+    {
+        // rehash(0) picks the smallest bucket count that keeps the load factor under max_load_factor
+        _table->rehash(0);
+    }
+    std::size_t after = memory_usage();
+    return (after < before) ? before - after : 0;
+}
+
+void EdgeSet::_to_table()
+{
+    _table.reset(
+        _make_table(_inline, _inline + _size, 0, vertex_pair_hash(), std::equal_to<std::pair<Vertex, Vertex>>()));
+    _size = 0;
+}
+
+void EdgeSet::_to_inline()
+{
+    _size = 0;
+    for (auto k = _table->begin(); k != _table->end(); ++k)
+    {
+        _inline[_size++] = *k;
+    }
+    _table.reset();
 }
 
-EdgeSet::EdgeSet(EdgeSet &&other) : _internal_set(std::move(other._internal_set))
+EdgeSet::EdgeSet(EdgeSet &&other) : _size(other._size), _arena(other._arena), _table(std::move(other._table))
 {
+    for (std::uint32_t i = 0; i < _size; ++i)
+    {
+        _inline[i] = other._inline[i];
+    }
+    other._size = 0;
 }
 
 EdgeSet &EdgeSet::operator=(EdgeSet &&other)
@@ -55,19 +166,54 @@ EdgeSet &EdgeSet::operator=(EdgeSet &&other)
     // don't move to self
     if (this != &other)
     {
-        _internal_set = std::move(other._internal_set);
+        _size = other._size;
+        for (std::uint32_t i = 0; i < _size; ++i)
+        {
+            _inline[i] = other._inline[i];
+        }
+        _table = std::move(other._table);
+        other._size = 0;
     }
     return *this;
 }
 
+EdgeSet EdgeSet::copy() const
+{
+    EdgeSet result;
+    result._size = _size;
+    result._arena = _arena;
+    for (std::uint32_t i = 0; i < _size; ++i)
+    {
+        result._inline[i] = _inline[i];
+    }
+    if (_table)
+    {
+        result._table.reset(_make_table(*_table));
+    }
+    return result;
+}
+
+void EdgeSet::set_arena(std::uint32_t arena)
+{
+    _arena = arena;
+}
+
 EdgeSetIterator EdgeSet::begin()
 {
-    return _internal_set.begin();
+    if (_table)
+    {
+        return EdgeSetIterator(EdgeHashSet::const_iterator(_table->begin()));
+    }
+    return EdgeSetIterator(_inline);
 }
 
 EdgeSetIterator EdgeSet::end()
 {
-    return _internal_set.end();
+    if (_table)
+    {
+        return EdgeSetIterator(EdgeHashSet::const_iterator(_table->end()));
+    }
+    return EdgeSetIterator(_inline + _size);
 }
 
 Vertex EdgeSet::other_end(EdgeSetIterator it, Vertex v)
@@ -77,9 +223,22 @@ Vertex EdgeSet::other_end(EdgeSetIterator it, Vertex v)
 
 void EdgeSet::print()
 {
-    for (auto k = _internal_set.begin(); k != _internal_set.end(); ++k)
+    for (auto k = begin(); k != end(); ++k)
     {
         std::cout << "(" << k->first << "," << k->second << ")" << "\t";
     }
     std::cout << std::endl;
-}
\ No newline at end of file
+}
+
+std::size_t EdgeSet::memory_usage()
+{
+    if (!_table)
+    {
+        return 0;
+    }
+    // a table holding no element uses the single bucket stored inside the set
+    std::size_t buckets = (_table->bucket_count() > 1) ? my::allocation_bytes(_table->bucket_count() * sizeof(void *)) : 0;
+    // every node holds the next pointer, the pair and the cached hash (vertex_pair_hash is not noexcept, so libstdc++ caches it)
+    std::size_t node = my::allocation_bytes(sizeof(void *) + sizeof(std::pair<Vertex, Vertex>) + sizeof(std::size_t));
+    return my::allocation_bytes(sizeof(EdgeHashSet)) + buckets + _table->size() * node;
+}
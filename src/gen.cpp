@@ -1,9 +1,103 @@
 #include "gen.hpp"
 #include <boost/graph/random.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
 
 using namespace boost;
 
+namespace
+{
+    typedef std::vector<std::pair<Vertex, Vertex>> EdgeList;
+
+    // edges drawn by one task of the parallel generators, fixed so that the output does not depend on the thread count
+    const long GEN_CHUNK = 1 << 20;
+
+    std::uint64_t chunk_seed(std::uint64_t seed, std::uint64_t chunk)
+    {
+        // splitmix64, nearby chunks get unrelated streams
+        std::uint64_t x = seed + (chunk + 1) * 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // parallel_chunks runs fill for every chunk on the given number of threads, and concatenates the edges in chunk order
+    EdgeList parallel_chunks(long chunks, int threads, const std::function<void(long chunk, EdgeList &out)> &fill)
+    {
+        if (threads <= 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        std::vector<EdgeList> parts(chunks);
+        std::atomic<long> next(0);
+        auto worker = [&]()
+        {
+            for (long c = next++; c < chunks; c = next++)
+            {
+                fill(c, parts[c]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads && t < chunks; ++t)
+        {
+            pool.push_back(std::thread(worker));
+        }
+        worker();
+        for (auto it = pool.begin(); it != pool.end(); ++it)
+        {
+            it->join();
+        }
+
+        std::size_t total = 0;
+        for (auto it = parts.begin(); it != parts.end(); ++it)
+        {
+            total += it->size();
+        }
+        EdgeList edges;
+        edges.reserve(total);
+        for (auto it = parts.begin(); it != parts.end(); ++it)
+        {
+            edges.insert(edges.end(), it->begin(), it->end());
+            // release every part right away, the edge list of a large graph should not exist twice for long
+            EdgeList().swap(*it);
+        }
+        return edges;
+    }
+
+    // build_graph drops self loops and parallel edges, sorts the rest and builds G from them in one pass
+    void build_graph(Graph &G, std::size_t n, EdgeList &edges, std::vector<Edge> &edge_handles)
+    {
+        assert(num_vertices(G) == 0);
+        for (auto it = edges.begin(); it != edges.end(); ++it)
+        {
+            if (it->second < it->first)
+            {
+                std::swap(it->first, it->second);
+            }
+        }
+        edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                   [](const std::pair<Vertex, Vertex> &e)
+                                   { return e.first == e.second; }),
+                    edges.end());
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        Graph built(edges.begin(), edges.end(), n);
+        G.swap(built);
+        edge_handles.reserve(edge_handles.size() + edges.size());
+        EdgeIterator ei, eiend;
+        for (tie(ei, eiend) = boost::edges(G); ei != eiend; ++ei)
+        {
+            edge_handles.push_back(*ei);
+        }
+    }
+}
+
 void gen::generate_ring(Graph &G, int n, std::vector<Edge> &edge_handles)
 {
     assert(n > 0);
@@ -50,4 +144,211 @@ void gen::generate_fully_connected(Graph &G, int n, std::vector<Edge> &edge_hand
             edge_handles.push_back(add_edge(i, j, G).first);
         }
     }
-}
\ No newline at end of file
+}
+
+std::vector<std::pair<Vertex, Vertex>> gen::deletion_sequence(const Graph &G, mt19937 &mt)
+{
+    std::vector<std::pair<Vertex, Vertex>> seq;
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(G); ei != eiend; ++ei)
+    {
+        seq.push_back(std::make_pair(source(*ei, G), target(*ei, G)));
+    }
+    // Fisher-Yates, boost generators do not satisfy std::shuffle
+    for (std::size_t i = seq.size(); i > 1; --i)
+    {
+        std::swap(seq[i - 1], seq[mt() % i]);
+    }
+    return seq;
+}
+
+void gen::generate_rmat(Graph &G, int scale, long m, std::vector<Edge> &edge_handles, std::uint64_t seed, double a, double b,
+                        double c, int threads)
+{
+    assert(scale > 0 && scale < 63 && m >= 0 && a >= 0 && b >= 0 && c >= 0 && a + b + c <= 1.0);
+    std::size_t n = static_cast<std::size_t>(1) << scale;
+    long chunks = (m + GEN_CHUNK - 1) / GEN_CHUNK;
+    auto fill = [&](long chunk, EdgeList &out)
+    {
+        std::mt19937_64 rng(chunk_seed(seed, chunk));
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        long count = std::min(GEN_CHUNK, m - chunk * GEN_CHUNK);
+        out.reserve(count);
+        for (long i = 0; i < count; ++i)
+        {
+            Vertex u = 0;
+            Vertex v = 0;
+            for (int level = 0; level < scale; ++level)
+            {
+                double r = dist(rng);
+                u <<= 1;
+                v <<= 1;
+                if (r < a)
+                {
+                    continue;
+                }
+                if (r < a + b)
+                {
+                    v |= 1;
+                }
+                else if (r < a + b + c)
+                {
+                    u |= 1;
+                }
+                else
+                {
+                    u |= 1;
+                    v |= 1;
+                }
+            }
+            out.push_back(std::make_pair(u, v));
+        }
+    };
+    EdgeList edges = parallel_chunks(chunks, threads, fill);
+
+    // the model puts the hubs on the small ids, shuffle the ids so they are spread over the graph like in real data
+    std::vector<Vertex> perm(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        perm[i] = i;
+    }
+    std::mt19937_64 rng(seed);
+    for (std::size_t i = n; i > 1; --i)
+    {
+        std::swap(perm[i - 1], perm[rng() % i]);
+    }
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+    {
+        it->first = perm[it->first];
+        it->second = perm[it->second];
+    }
+    build_graph(G, n, edges, edge_handles);
+}
+
+void gen::generate_grid_2d(Graph &G, long nx, long ny, std::vector<Edge> &edge_handles)
+{
+    generate_grid_3d(G, nx, ny, 1, edge_handles);
+}
+
+void gen::generate_grid_3d(Graph &G, long nx, long ny, long nz, std::vector<Edge> &edge_handles)
+{
+    assert(nx > 0 && ny > 0 && nz > 0);
+    EdgeList edges;
+    edges.reserve(3 * nx * ny * nz);
+    for (long z = 0; z < nz; ++z)
+    {
+        for (long y = 0; y < ny; ++y)
+        {
+            for (long x = 0; x < nx; ++x)
+            {
+                Vertex id = x + nx * (y + ny * z);
+                if (x + 1 < nx)
+                {
+                    edges.push_back(std::make_pair(id, id + 1));
+                }
+                if (y + 1 < ny)
+                {
+                    edges.push_back(std::make_pair(id, id + nx));
+                }
+                if (z + 1 < nz)
+                {
+                    edges.push_back(std::make_pair(id, id + nx * ny));
+                }
+            }
+        }
+    }
+    build_graph(G, nx * ny * nz, edges, edge_handles);
+}
+
+void gen::generate_barabasi_albert(Graph &G, long n, int k, std::vector<Edge> &edge_handles, std::uint64_t seed)
+{
+    assert(n > 0 && k > 0);
+    // every edge is two consecutive entries of ends, picking a uniform entry picks a vertex proportionally to its degree
+    std::vector<Vertex> ends(2 * n * k);
+    std::mt19937_64 rng(seed);
+    for (long v = 0; v < n; ++v)
+    {
+        for (int i = 0; i < k; ++i)
+        {
+            std::size_t idx = 2 * (v * k + i);
+            ends[idx] = v;
+            ends[idx + 1] = ends[rng() % (idx + 1)];
+        }
+    }
+    EdgeList edges(n * k);
+    for (std::size_t i = 0; i < edges.size(); ++i)
+    {
+        edges[i] = std::make_pair(ends[2 * i], ends[2 * i + 1]);
+    }
+    std::vector<Vertex>().swap(ends);
+    build_graph(G, n, edges, edge_handles);
+}
+
+void gen::generate_sbm(Graph &G, long n, int blocks, double p_in, double p_out, std::vector<Edge> &edge_handles,
+                       std::uint64_t seed, int threads)
+{
+    assert(n > 0 && blocks > 0 && blocks <= n && p_in >= 0 && p_in <= 1 && p_out >= 0 && p_out <= 1);
+    // block i holds [first(i), first(i + 1))
+    auto first = [n, blocks](long i)
+    {
+        return i * n / blocks;
+    };
+    // the rows x cols pairs of every pair of blocks i <= j are cut into ranges of about GEN_CHUNK expected edges, one task
+    // each, so that a single dense block is spread over the threads like the other generators
+    struct Task
+    {
+        long i;
+        long j;
+        long begin;
+        long end;
+    };
+    std::vector<Task> tasks;
+    for (long i = 0; i < blocks; ++i)
+    {
+        for (long j = i; j < blocks; ++j)
+        {
+            double p = (i == j) ? p_in : p_out;
+            if (p <= 0.0)
+            {
+                continue;
+            }
+            long total = (first(i + 1) - first(i)) * (first(j + 1) - first(j));
+            long span = static_cast<long>(std::min(static_cast<double>(total), std::max(1.0, GEN_CHUNK / p)));
+            for (long begin = 0; begin < total; begin += span)
+            {
+                tasks.push_back(Task{i, j, begin, std::min(total, begin + span)});
+            }
+        }
+    }
+    auto fill = [&](long task, EdgeList &out)
+    {
+        long i = tasks[task].i;
+        long j = tasks[task].j;
+        double p = (i == j) ? p_in : p_out;
+        long cols = first(j + 1) - first(j);
+        long end = tasks[task].end;
+        std::mt19937_64 rng(chunk_seed(seed, task));
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        double log_q = std::log1p(-p);
+        // walk the pairs of the range, jumping over the ones not drawn. Inside a block both orders of a pair are walked and
+        // only x < y is kept, which draws every unordered pair once with probability p.
+        for (long idx = tasks[task].begin - 1;;)
+        {
+            double skip = (p >= 1.0) ? 0.0 : std::floor(std::log1p(-dist(rng)) / log_q);
+            // compared as double, a tiny p can give skips beyond the range of long
+            if (skip >= static_cast<double>(end - idx - 1))
+            {
+                break;
+            }
+            idx += 1 + static_cast<long>(skip);
+            Vertex x = first(i) + idx / cols;
+            Vertex y = first(j) + idx % cols;
+            if (i != j || x < y)
+            {
+                out.push_back(std::make_pair(x, y));
+            }
+        }
+    };
+    EdgeList edges = parallel_chunks(tasks.size(), threads, fill);
+    build_graph(G, n, edges, edge_handles);
+}
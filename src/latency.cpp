@@ -0,0 +1,158 @@
+#include "latency.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LATENCY_HAS_TSC 1
+#endif
+
+std::uint64_t my::clock_ticks()
+{
+#ifdef LATENCY_HAS_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double my::ticks_per_ns()
+{
+#ifdef LATENCY_HAS_TSC
+    // the counter runs at a constant rate on every CPU of the last decade, one calibration is enough
+    static const double rate = []()
+    {
+        auto t1 = std::chrono::steady_clock::now();
+        std::uint64_t c1 = __rdtsc();
+        while (std::chrono::steady_clock::now() - t1 < std::chrono::milliseconds(5))
+        {
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        std::uint64_t c2 = __rdtsc();
+        return static_cast<double>(c2 - c1) / std::chrono::duration<double, std::nano>(t2 - t1).count();
+    }();
+    return rate;
+#else
+    return 1.0;
+#endif
+}
+
+double my::ticks_to_ns(double ticks)
+{
+    return ticks / ticks_per_ns();
+}
+
+double my::ticks_to_ms(double ticks)
+{
+    return ticks_to_ns(ticks) / 1e6;
+}
+
+my::LatencyHistogram::LatencyHistogram() : _counts(NUM_BUCKETS, 0)
+{
+    reset();
+}
+
+int my::LatencyHistogram::_bucket(std::uint64_t ticks)
+{
+    if (ticks < 2 * SUB_BUCKETS)
+    {
+        return static_cast<int>(ticks);
+    }
+    // keep the highest bit and the log2(SUB_BUCKETS) bits below it
+    int msb = 63 - __builtin_clzll(ticks);
+    int shift = msb - 4;
+    int sub = static_cast<int>(ticks >> shift) - SUB_BUCKETS;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t my::LatencyHistogram::_bucket_upper(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int shift = (bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    std::uint64_t sub = (bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    if (shift + 5 >= 64 && sub == 2 * SUB_BUCKETS - 1)
+    {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+    return ((sub + 1) << shift) - 1;
+}
+
+void my::LatencyHistogram::record(std::uint64_t ticks)
+{
+    ++_counts[_bucket(ticks)];
+    ++_count;
+    _min = std::min(_min, ticks);
+    _max = std::max(_max, ticks);
+    _sum += static_cast<double>(ticks);
+}
+
+void my::LatencyHistogram::reset()
+{
+    std::fill(_counts.begin(), _counts.end(), 0);
+    _count = 0;
+    _min = std::numeric_limits<std::uint64_t>::max();
+    _max = 0;
+    _sum = 0.0;
+}
+
+my::LatencyHistogram &my::LatencyHistogram::operator+=(const LatencyHistogram &other)
+{
+    for (int i = 0; i < NUM_BUCKETS; ++i)
+    {
+        _counts[i] += other._counts[i];
+    }
+    _count += other._count;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _sum += other._sum;
+    return *this;
+}
+
+std::uint64_t my::LatencyHistogram::count() const
+{
+    return _count;
+}
+
+std::uint64_t my::LatencyHistogram::min() const
+{
+    return _count > 0 ? _min : 0;
+}
+
+std::uint64_t my::LatencyHistogram::max() const
+{
+    return _max;
+}
+
+double my::LatencyHistogram::mean() const
+{
+    return _count > 0 ? _sum / _count : 0.0;
+}
+
+std::uint64_t my::LatencyHistogram::percentile(double p) const
+{
+    assert(p >= 0.0 && p <= 100.0);
+    if (_count == 0)
+    {
+        return 0;
+    }
+    // nearest rank, same as bench::compute_stats
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * _count));
+    rank = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i)
+    {
+        seen += _counts[i];
+        if (seen >= rank)
+        {
+            // the bucket bound can lie beyond the largest value recorded
+            return std::min(_bucket_upper(i), _max);
+        }
+    }
+    return _max;
+}
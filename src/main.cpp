@@ -1,492 +1,678 @@
 #include <iostream>
 #include <cassert>
-#include <ctime>
-#include <queue>
+#include <filesystem>
 #include "graph.hpp"
 #include <vector>
 #include "algo.hpp"
 #include "dyn_graph.hpp"
+#include "offline_dyn_graph.hpp"
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/graph/random.hpp>
 #include "gen.hpp"
+#include "adversarial.hpp"
+#include "reordered_dyn_graph.hpp"
+#include "bench.hpp"
 #include "util.hpp"
+#include "latency.hpp"
 
-#include <chrono>
-#include <ctime>
-#include <ratio>
+using namespace boost;
 
-#define ITERATIONS 100
+// random_root picks the root of a DynGraph from the seeded generator, instead of the time based default
+Vertex random_root(const Graph &G, mt19937 &mt)
+{
+    return vertex(mt() % num_vertices(G), G);
+}
 
-using namespace boost;
+// measure_deletion removes e from G, times the reorganization of DG and a DFS query for the same endpoints into row,
+// and makes sure both give the same answer
+void measure_deletion(Graph &G, DynGraph &DG, Edge e, std::vector<double> &row)
+{
+    Vertex src = source(e, G);
+    Vertex trgt = target(e, G);
+    remove_edge(e, G);
+    // now remove the edge, DG times the restructuring itself
+    DG.reorg_after_remove(trgt, src);
+    row[0] = my::ticks_to_ms(DG.last_reorg_ticks());
+    std::uint64_t t1 = my::clock_ticks();
+    bool dfs_found = my::dfs_scan(G, src, trgt);
+    row[1] = my::ticks_to_ms(my::clock_ticks() - t1);
+    // make sure correct results are returned
+    assert((DG.query_is_connected(src, trgt) == dfs_found));
+}
 
-std::vector<std::vector<std::vector<double>>> bench_line_q_queries(std::vector<int> &cases)
+// measure_reorg removes e from G and only times the reorganization of DG
+double measure_reorg(Graph &G, DynGraph &DG, Edge e)
 {
-    // Cases X Queries X 2
-    std::vector<std::vector<std::vector<double>>> res(cases.size());
+    Vertex src = source(e, G);
+    Vertex trgt = target(e, G);
+    remove_edge(e, G);
+    DG.reorg_after_remove(trgt, src);
+    return my::ticks_to_ms(DG.last_reorg_ticks());
+}
 
-    for (int c = 0; c < cases.size(); ++c)
+// report_latencies hands the histograms DG recorded during a run to the harness
+void report_latencies(DynGraph &DG, const std::string &prefix = "")
+{
+    bench::report_latency(prefix + "reorg", DG.reorg_latency());
+    if (DG.query_latency().count() > 0)
     {
+        bench::report_latency(prefix + "query", DG.query_latency());
+    }
+}
 
-        // assert that vertices are a power of two
-        // this will get the worst case complexity
-        std::cout << cases[c] << std::endl;
-        assert((cases[c] > 0) && ((cases[c] & (cases[c] - 1)) == 0));
-
-        // for the line graph benchmark, all edges will be removed
-        auto query_num = cases[c] - 1;
-        // will keep avg time for each query
-        res[c] = std::vector<std::vector<double>>(query_num, std::vector<double>(2, 0.0));
+void run_random_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    // each case is one random graph with one deletion sequence, every iteration repeats them
+    mt19937 mt(case_seed);
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_random(G, params[0], params[1], edge_handles, mt);
+    DynGraph DG(G, random_root(G, mt));
+
+    mt19937 edge_mt(case_seed + 1072558);
+    auto query_num = params[1] - 1;
+    times.assign(query_num, std::vector<double>(2, 0.0));
+    for (int q = 0; q < query_num; ++q)
+    {
+        measure_deletion(G, DG, random_edge(G, edge_mt), times[q]);
+    }
+    report_latencies(DG);
+}
 
-        for (int iter = 0; iter < ITERATIONS; ++iter)
-        {
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_line(G, cases[c], edge_handles);
-            DynGraph DG(G);
-
-            // this will halve the line every time, making it
-            // the worst case for process A
-            std::queue<Vertex> vq;
-            int level = cases[c] / 4;
-            int limit = 1;
-            int limit_counter = 0;
-            vq.push(cases[c] / 2);
-            for (int q = 0; q < query_num; ++q)
-            {
-                int current = vq.front();
-                vq.pop();
-
-                vq.push(current - level);
-                vq.push(current + level);
-
-                ++limit_counter;
-                if (limit_counter == limit)
-                {
-                    level /= 2;
-                    limit *= 2;
-                    limit_counter = 0;
-                }
-
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = edge(current, current - 1, G).first;
-                Vertex src = source(e, G);
-                Vertex trgt = target(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-                // save time elapsed to dynamically restructure
-                res[c][q][0] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                bool dfs_found = false;
-                t1 = std::chrono::high_resolution_clock::now();
-                dfs_found = my::dfs_scan(G, src, trgt);
-                t2 = std::chrono::high_resolution_clock::now();
-                res[c][q][1] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                // make sure correct results are returned
-                assert((DG.query_is_connected(src, trgt) == dfs_found));
-            }
-        }
+void run_line_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_line(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    // for the line graph benchmark, all edges will be removed
+    std::vector<Vertex> seq = gen::halving_sequence(params[0]);
+    times.assign(seq.size(), std::vector<double>(2, 0.0));
+    for (std::size_t q = 0; q < seq.size(); ++q)
+    {
+        measure_deletion(G, DG, edge(seq[q], seq[q] - 1, G).first, times[q]);
+    }
+    report_latencies(DG);
+}
 
-        // take avg per query over iterations
-        for (int q = 0; q < query_num; ++q)
-        {
-            res[c][q][0] /= ITERATIONS;
-            res[c][q][1] /= ITERATIONS;
-        }
+void run_line_q_random_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_line(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    auto query_num = params[0] - 1;
+    times.assign(query_num, std::vector<double>(2, 0.0));
+    for (int q = 0; q < query_num; ++q)
+    {
+        measure_deletion(G, DG, random_edge(G, mt), times[q]);
     }
+    report_latencies(DG);
+}
 
-    return res;
+void run_ring_q_random_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_ring(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    auto query_num = params[0] - 1;
+    times.assign(query_num, std::vector<double>(2, 0.0));
+    for (int q = 0; q < query_num; ++q)
+    {
+        measure_deletion(G, DG, random_edge(G, mt), times[q]);
+    }
+    report_latencies(DG);
 }
 
-std::vector<std::vector<std::vector<double>>> bench_line_q_random_queries(std::vector<int> &cases)
+void run_fully_connected_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
 {
-    // Cases X Queries X 2
-    std::vector<std::vector<std::vector<double>>> res(cases.size());
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_fully_connected(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    long query_num = params[0] * (params[0] - 1) / 2;
+    times.assign(query_num, std::vector<double>(2, 0.0));
+    for (long q = 0; q < query_num; ++q)
+    {
+        measure_deletion(G, DG, random_edge(G, mt), times[q]);
+    }
+    report_latencies(DG);
+}
 
-    for (int c = 0; c < cases.size(); ++c)
+void run_worst_process_a(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_line(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    // total time of removing every edge in halving order
+    std::vector<Vertex> seq = gen::halving_sequence(params[0]);
+    times.assign(1, std::vector<double>(1, 0.0));
+    for (std::size_t q = 0; q < seq.size(); ++q)
     {
+        times[0][0] += measure_reorg(G, DG, edge(seq[q], seq[q] - 1, G).first);
+    }
+    report_latencies(DG);
+}
 
-        // assert that vertices are a power of two
-        // this will get the worst case complexity
-        std::cout << cases[c] << std::endl;
-        assert(cases[c] > 0);
+void run_worst_process_b(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_ring(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+
+    // will only remove the edge before the root, which causes worst-case restructuring with process B
+    Vertex r = DG.get_root();
+    times.assign(1, std::vector<double>(1, 0.0));
+    times[0][0] = measure_reorg(G, DG, edge(r, (r + params[0] - 1) % params[0], G).first);
+    report_latencies(DG);
+}
 
-        // for the line graph benchmark, all edges will be removed
-        auto query_num = cases[c] - 1;
-        // will keep avg time for each query
-        res[c] = std::vector<std::vector<double>>(query_num, std::vector<double>(2, 0.0));
+// run_workload builds the ES structure of an adversarial workload and times its deletions, the total in the first column
+// The adversarial workloads are fixed by their parameters, so their runners ignore the case seed and the iteration.
+void run_workload(Graph &G, const gen::Workload &workload, bench::Times &times)
+{
+    DynGraph DG(G, workload.root);
+    times.assign(1, std::vector<double>(1, 0.0));
+    for (auto it = workload.deletions.begin(); it != workload.deletions.end(); ++it)
+    {
+        remove_edge(edge(it->first, it->second, G).first, G);
+        DG.reorg_after_remove(it->first, it->second);
+        times[0][0] += my::ticks_to_ms(DG.last_reorg_ticks());
+    }
+    report_latencies(DG);
+}
 
-        mt19937 mt(time(0));
+void run_adversarial_level_bumps(const std::vector<long> &params, std::uint64_t, int, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::Workload workload = gen::adversarial_level_bumps(G, params[0], params[1], edge_handles);
+    run_workload(G, workload, times);
+}
 
-        for (int iter = 0; iter < ITERATIONS; ++iter)
-        {
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_line(G, cases[c], edge_handles);
-            DynGraph DG(G);
+void run_adversarial_race(const std::vector<long> &params, std::uint64_t, int, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::Workload workload = gen::adversarial_race(G, params[0], params[1], edge_handles);
+    run_workload(G, workload, times);
+}
 
-            for (int q = 0; q < query_num; ++q)
-            {
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = random_edge(G, mt);
-                Vertex src = source(e, G);
-                Vertex trgt = target(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-                // save time elapsed to dynamically restructure
-                res[c][q][0] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                bool dfs_found = false;
-                t1 = std::chrono::high_resolution_clock::now();
-                dfs_found = my::dfs_scan(G, src, trgt);
-                t2 = std::chrono::high_resolution_clock::now();
-                res[c][q][1] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                // make sure correct results are returned
-                assert((DG.query_is_connected(src, trgt) == dfs_found));
-            }
-        }
+void run_adversarial_halving(const std::vector<long> &params, std::uint64_t, int, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::Workload workload = gen::adversarial_halving(G, params[0], params[1], edge_handles);
+    run_workload(G, workload, times);
+}
 
-        // take avg per query over iterations
+void run_engines_random_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    // the state machine engine in the first column, the coroutine engine in the second
+    const ReorgEngine engines[2] = {ReorgEngine::StateMachine, ReorgEngine::Coroutine};
+    auto query_num = params[1] - 1;
+    times.assign(query_num, std::vector<double>(2, 0.0));
+
+    for (int en = 0; en < 2; ++en)
+    {
+        // both engines see the same graph, root and deletion sequence
+        mt19937 mt(case_seed);
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_random(G, params[0], params[1], edge_handles, mt);
+        DynGraph DG(G, random_root(G, mt));
+        DG.set_engine(engines[en]);
+
+        mt19937 edge_mt(case_seed + 1072558);
         for (int q = 0; q < query_num; ++q)
         {
-            res[c][q][0] /= ITERATIONS;
-            res[c][q][1] /= ITERATIONS;
+            times[q][en] = measure_reorg(G, DG, random_edge(G, edge_mt));
         }
+        report_latencies(DG, en == 0 ? "state_machine_" : "coroutine_");
     }
-
-    return res;
 }
 
-std::vector<std::vector<std::vector<double>>> bench_ring_q_random_queries(std::vector<int> &cases)
+void run_offline_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
 {
-    // Cases X Queries X 2
-    std::vector<std::vector<std::vector<double>>> res(cases.size());
-
-    for (int c = 0; c < cases.size(); ++c)
+    // total time of deleting every edge and querying its endpoints, the ES structure in the first column, the offline
+    // union-find in the second. Both include building the structure.
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_random(G, params[0], params[1], edge_handles, mt);
+    Graph G_offline(G);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    Vertex r = random_root(G, mt);
+
+    times.assign(1, std::vector<double>(2, 0.0));
+    std::vector<bool> answers(deletions.size());
+    std::uint64_t t1 = my::clock_ticks();
+    DynGraph DG(G, r);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
     {
+        DG.dyn_remove_edge(edge(deletions[q].first, deletions[q].second, G).first);
+        answers[q] = DG.query_is_connected(deletions[q].first, deletions[q].second);
+    }
+    times[0][0] = my::ticks_to_ms(my::clock_ticks() - t1);
 
-        // assert that vertices are a number of two
-        // this will get the worst case complexity
-        std::cout << cases[c] << std::endl;
-        assert(cases[c] > 0);
-
-        // for the line graph benchmark, all edges will be removed
-        auto query_num = cases[c] - 1;
-        // will keep avg time for each query
-        res[c] = std::vector<std::vector<double>>(query_num, std::vector<double>(2, 0.0));
+    bool agree = true;
+    t1 = my::clock_ticks();
+    OfflineDynGraph ODG(G_offline, deletions);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        ODG.dyn_remove_edge(edge(deletions[q].first, deletions[q].second, G_offline).first);
+        agree = agree && (ODG.query_is_connected(deletions[q].first, deletions[q].second) == answers[q]);
+    }
+    times[0][1] = my::ticks_to_ms(my::clock_ticks() - t1);
+    assert(agree && "Offline answers differ from DynGraph.");
+    report_latencies(DG);
+}
 
-        mt19937 mt(time(0));
+// run_sampled_deletions times the deletion of up to query_num random edges of G, with a DFS check of every one
+void run_sampled_deletions(Graph &G, std::vector<Edge> &edge_handles, long query_num, mt19937 &mt, bench::Times &times)
+{
+    // the first query_num handles of a shuffle are distinct, so none of them has been removed when it is used
+    for (std::size_t i = edge_handles.size(); i > 1; --i)
+    {
+        std::swap(edge_handles[i - 1], edge_handles[mt() % i]);
+    }
+    query_num = std::min<long>(query_num, edge_handles.size());
+    DynGraph DG(G, random_root(G, mt));
+    times.assign(query_num, std::vector<double>(2, 0.0));
+    for (long q = 0; q < query_num; ++q)
+    {
+        measure_deletion(G, DG, edge_handles[q], times[q]);
+    }
+    report_latencies(DG);
+}
 
-        for (int iter = 0; iter < ITERATIONS; ++iter)
-        {
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_ring(G, cases[c], edge_handles);
-            DynGraph DG(G);
+// deletions timed per run of the generator suites, the graphs are too large to delete every edge
+const long SAMPLED_DELETIONS = 500;
 
-            for (int q = 0; q < query_num; ++q)
-            {
+// the generator suites build the same graph for every iteration from case_seed, and sample the deletions from the iteration
+void run_rmat_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_rmat(G, params[0], params[1], edge_handles, case_seed);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    run_sampled_deletions(G, edge_handles, SAMPLED_DELETIONS, mt, times);
+}
 
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = random_edge(G, mt);
-                Vertex src = source(e, G);
-                Vertex trgt = target(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-                // save time elapsed to dynamically restructure
-                res[c][q][0] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                bool dfs_found = false;
-                t1 = std::chrono::high_resolution_clock::now();
-                dfs_found = my::dfs_scan(G, src, trgt);
-                t2 = std::chrono::high_resolution_clock::now();
-                res[c][q][1] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                // make sure correct results are returned
-                assert((DG.query_is_connected(src, trgt) == dfs_found));
-            }
-        }
+void run_grid_2d_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_grid_2d(G, params[0], params[0], edge_handles);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    run_sampled_deletions(G, edge_handles, SAMPLED_DELETIONS, mt, times);
+}
 
-        // take avg per query over iterations
-        for (int q = 0; q < query_num; ++q)
-        {
-            res[c][q][0] /= ITERATIONS;
-            res[c][q][1] /= ITERATIONS;
-        }
-    }
+void run_grid_3d_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_grid_3d(G, params[0], params[0], params[0], edge_handles);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    run_sampled_deletions(G, edge_handles, SAMPLED_DELETIONS, mt, times);
+}
 
-    return res;
+void run_barabasi_albert_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_barabasi_albert(G, params[0], params[1], edge_handles, case_seed);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    run_sampled_deletions(G, edge_handles, SAMPLED_DELETIONS, mt, times);
 }
 
-std::vector<std::vector<std::vector<double>>> bench_random_q_queries(std::vector<std::pair<int, int>> &cases)
+void run_sbm_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
 {
-    // Cases X Queries X 2
-    std::vector<std::vector<std::vector<double>>> res(cases.size());
+    // on average 8 neighbours inside the own block and 1 outside
+    long block = params[0] / params[1];
+    double p_in = std::min(1.0, 8.0 / std::max<long>(block - 1, 1));
+    double p_out = (params[1] > 1) ? std::min(1.0, 1.0 / (params[0] - block)) : 0.0;
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_sbm(G, params[0], params[1], p_in, p_out, edge_handles, case_seed);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    run_sampled_deletions(G, edge_handles, SAMPLED_DELETIONS, mt, times);
+}
 
-    for (int c = 0; c < cases.size(); ++c)
+// measure_memory fills a single row with the footprint of DG after a sample of deletions from edge_handles, so that the change
+// log peak is representative: bytes per vertex and per edge in total, the graph and the edge sets per edge, and the change log peak
+void measure_memory(Graph &G, DynGraph &DG, const std::vector<Edge> &edge_handles, bench::Times &times, bool sample_deletions = true)
+{
+    // evenly spread handles are distinct, so none of them has been removed before
+    std::size_t deletions = sample_deletions ? std::min<std::size_t>(1000, edge_handles.size() / 100) : 0;
+    for (std::size_t q = 0; q < deletions; ++q)
     {
+        DG.dyn_remove_edge(edge_handles[q * (edge_handles.size() / deletions)]);
+    }
 
-        std::cout << cases[c].first << " " << cases[c].second << std::endl;
-
-        // for the line graph benchmark, all edges will be removed
-        auto query_num = cases[c].second - 1;
-        // will keep avg time for each query
-        res[c] = std::vector<std::vector<double>>(query_num, std::vector<double>(2, 0.0));
-
-        auto seed = time(0) + c;
-        std::cout << "seed: " << seed << std::endl;
+    my::MemoryUsage usage = DG.memory_usage();
+    double n = static_cast<double>(num_vertices(G));
+    double m = static_cast<double>(std::max<std::size_t>(num_edges(G), 1));
+    times.assign(1, std::vector<double>(5, 0.0));
+    times[0][0] = usage.total() / n;
+    times[0][1] = usage.total() / m;
+    times[0][2] = usage.graph / m;
+    times[0][3] = (usage.alpha + usage.beta + usage.gamma) / m;
+    times[0][4] = static_cast<double>(usage.change_log_peak);
+}
 
-        for (int iter = 0; iter < ITERATIONS; ++iter)
-        {
-            // each case will be one random graph
-            // initializing a new mersenne twister RNG for every iteration with same seed to get same random graph
-            mt19937 mt(seed);
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_random(G, cases[c].first, cases[c].second, edge_handles, mt);
-            DynGraph DG(G);
+void run_memory_random(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    // average degree 8
+    mt19937 mt(case_seed);
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_random(G, std::max<long>(params[0] / 4, 1), params[0], edge_handles, mt);
+    DynGraph DG(G, random_root(G, mt));
+    measure_memory(G, DG, edge_handles, times);
+}
 
-            mt19937 edge_mt(seed + 1072558);
+void run_memory_line(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    mt19937 mt(case_seed);
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_line(G, params[0] + 1, edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+    measure_memory(G, DG, edge_handles, times);
+}
 
-            for (int q = 0; q < query_num; ++q)
-            {
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = random_edge(G, edge_mt);
-                Vertex src = source(e, G);
-                Vertex trgt = target(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-                // save time elapsed to dynamically restructure
-                res[c][q][0] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                bool dfs_found = false;
-                t1 = std::chrono::high_resolution_clock::now();
-                dfs_found = my::dfs_scan(G, src, trgt);
-                t2 = std::chrono::high_resolution_clock::now();
-                res[c][q][1] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                // make sure correct results are returned
-                assert((DG.query_is_connected(src, trgt) == dfs_found));
-            }
-        }
+void run_memory_ring(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    mt19937 mt(case_seed);
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_ring(G, params[0], edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+    // a deletion on a ring can raise O(n^2) levels (see worst_b), so the change log peak is left out
+    measure_memory(G, DG, edge_handles, times, false);
+}
 
-        // take avg per query over iterations
-        for (int q = 0; q < query_num; ++q)
-        {
-            res[c][q][0] /= ITERATIONS;
-            res[c][q][1] /= ITERATIONS;
-        }
+void run_memory_fully_connected(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
+{
+    // the smallest complete graph with at least the requested number of edges
+    mt19937 mt(case_seed);
+    long n = 1;
+    while (n * (n - 1) / 2 < params[0])
+    {
+        ++n;
     }
-
-    return res;
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_fully_connected(G, n, edge_handles);
+    DynGraph DG(G, random_root(G, mt));
+    measure_memory(G, DG, edge_handles, times);
 }
 
-std::vector<std::vector<std::vector<double>>> bench_fully_connected_q_queries(std::vector<int> &cases)
+void run_memory_rmat(const std::vector<long> &params, std::uint64_t case_seed, int, bench::Times &times)
 {
-    // Cases X Queries X 2
-    std::vector<std::vector<std::vector<double>>> res(cases.size());
-
-    for (int c = 0; c < cases.size(); ++c)
+    // average degree 32 before dropping duplicates, like the Graph500 edge factor of 16
+    int scale = 1;
+    while ((16L << scale) < params[0])
     {
+        ++scale;
+    }
+    mt19937 mt(case_seed);
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_rmat(G, scale, params[0], edge_handles, case_seed);
+    DynGraph DG(G, random_root(G, mt));
+    measure_memory(G, DG, edge_handles, times);
+}
 
-        std::cout << cases[c] << std::endl;
-
-        // for the line graph benchmark, all edges will be removed
-        int query_num = cases[c] * (cases[c] - 1) / 2;
-        // will keep avg time for each query
-        res[c] = std::vector<std::vector<double>>(query_num, std::vector<double>(2, 0.0));
-
-        mt19937 mt(time(0));
+void run_endpoints_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    // whole deletions by endpoints, lookup and graph mutation included: edge() and dyn_remove_edge(Edge) in the first
+    // column, dyn_remove_edge(u, v) through the endpoint index in the second. Preferential attachment puts many of the
+    // sampled edges on hubs, where edge() scans long out-edge lists.
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_barabasi_albert(G, params[0], params[1], edge_handles, case_seed);
+    Graph G_index(G);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    deletions.resize(std::min<std::size_t>(deletions.size(), SAMPLED_DELETIONS));
+    Vertex r = random_root(G, mt);
+
+    times.assign(deletions.size(), std::vector<double>(2, 0.0));
+    DynGraph DG(G, r);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        std::uint64_t t1 = my::clock_ticks();
+        DG.dyn_remove_edge(edge(deletions[q].first, deletions[q].second, G).first);
+        times[q][0] = my::ticks_to_ms(my::clock_ticks() - t1);
+    }
+    DynGraph DG_index(G_index, r);
+    DG_index.build_edge_index();
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        std::uint64_t t1 = my::clock_ticks();
+        DG_index.dyn_remove_edge(deletions[q].first, deletions[q].second);
+        times[q][1] = my::ticks_to_ms(my::clock_ticks() - t1);
+    }
+    assert(DG._components == DG_index._components && "Deleting by endpoints changed the outcome.");
+}
 
-        for (int iter = 0; iter < ITERATIONS; ++iter)
+void run_reorder_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    // the same deletions on an R-MAT graph, whose ids are scattered, under every vertex order, one column each.
+    // Renumbering is done at load time and not timed.
+    const VertexOrder orders[4] = {VertexOrder::Identity, VertexOrder::Bfs, VertexOrder::ReverseCuthillMcKee,
+                                   VertexOrder::Degree};
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_rmat(G, params[0], params[1], edge_handles, case_seed);
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    deletions.resize(std::min<std::size_t>(deletions.size(), SAMPLED_DELETIONS));
+    Vertex r = random_root(G, mt);
+
+    times.assign(deletions.size(), std::vector<double>(4, 0.0));
+    std::vector<bool> answers(deletions.size());
+    for (int o = 0; o < 4; ++o)
+    {
+        ReorderedDynGraph RDG(G, orders[o], r);
+        for (std::size_t q = 0; q < deletions.size(); ++q)
         {
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_fully_connected(G, cases[c], edge_handles);
-            DynGraph DG(G);
-
-            for (int q = 0; q < query_num; ++q)
-            {
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = random_edge(G, mt);
-                Vertex src = source(e, G);
-                Vertex trgt = target(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-                // save time elapsed to dynamically restructure
-                res[c][q][0] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                bool dfs_found = false;
-                t1 = std::chrono::high_resolution_clock::now();
-                dfs_found = my::dfs_scan(G, src, trgt);
-                t2 = std::chrono::high_resolution_clock::now();
-                res[c][q][1] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-                // make sure correct results are returned
-                assert((DG.query_is_connected(src, trgt) == dfs_found));
-            }
+            RDG.dyn_remove_edge(deletions[q].first, deletions[q].second);
+            times[q][o] = my::ticks_to_ms(RDG.dyn_graph().last_reorg_ticks());
+            bool connected = RDG.query_is_connected(deletions[q].first, deletions[q].second);
+            assert((o == 0 || connected == answers[q]) && "The vertex order changed an answer.");
+            answers[q] = connected;
         }
+    }
+}
 
-        // take avg per query over iterations
-        for (int q = 0; q < query_num; ++q)
+void run_memory_policy_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
+{
+    // the same deletions on a random graph with the per-vertex arrays on the heap, on transparent and explicit huge pages,
+    // interleaved over the NUMA nodes and in files under the temporary directory, one column each. Every column deletes
+    // from a copy of the graph.
+    my::MemoryPolicy policies[5];
+    policies[1].pages = my::PagePolicy::Transparent;
+    policies[2].pages = my::PagePolicy::Explicit;
+    policies[3].numa = my::NumaPolicy::Interleave;
+    policies[4].directory = std::filesystem::temp_directory_path().string();
+    Graph G;
+    std::vector<Edge> edge_handles;
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    gen::generate_random(G, params[0], params[1], edge_handles, mt);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    deletions.resize(std::min<std::size_t>(deletions.size(), SAMPLED_DELETIONS));
+    Vertex r = random_root(G, mt);
+
+    times.assign(deletions.size(), std::vector<double>(5, 0.0));
+    for (int p = 0; p < 5; ++p)
+    {
+        Graph H(G);
+        DynGraph DG(H, r, policies[p]);
+        for (std::size_t q = 0; q < deletions.size(); ++q)
         {
-            res[c][q][0] /= ITERATIONS;
-            res[c][q][1] /= ITERATIONS;
+            DG.dyn_remove_edge(deletions[q].first, deletions[q].second);
+            times[q][p] = my::ticks_to_ms(DG.last_reorg_ticks());
         }
     }
-
-    return res;
 }
 
-std::vector<double> bench_worst_process_a(std::vector<int> &cases)
+void run_paths_q_queries(const std::vector<long> &params, std::uint64_t case_seed, int iteration, bench::Times &times)
 {
-    std::vector<double> res(cases.size(), 0.0);
-
-    for (int c = 0; c < cases.size(); ++c)
+    // after every deletion, a path from one endpoint to a random vertex through the BFS tree of the ES structure, and from a
+    // BFS of the whole graph
+    Graph G;
+    std::vector<Edge> edge_handles;
+    mt19937 mt(bench::iteration_seed(case_seed, iteration));
+    gen::generate_random(G, params[0], params[1], edge_handles, mt);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    deletions.resize(std::min<std::size_t>(deletions.size(), SAMPLED_DELETIONS));
+    DynGraph DG(G, random_root(G, mt));
+
+    std::vector<Vertex> parent;
+    times.assign(deletions.size(), std::vector<double>(2, 0.0));
+    for (std::size_t q = 0; q < deletions.size(); ++q)
     {
-
-        // assert that vertices are a power of two
-        // this will get the worst case complexity
-        std::cout << cases[c] << std::endl;
-        assert((cases[c] > 0) && ((cases[c] & (cases[c] - 1)) == 0));
-
-        // for the line graph benchmark, all edges will be removed
-        auto query_num = cases[c] - 1;
-
-        for (int iter = 0; iter < ITERATIONS; ++iter)
+        DG.dyn_remove_edge(deletions[q].first, deletions[q].second);
+        Vertex s = deletions[q].first;
+        Vertex t = vertex(mt() % num_vertices(G), G);
+
+        std::uint64_t t1 = my::clock_ticks();
+        std::vector<Vertex> path = DG.connecting_path(s, t);
+        times[q][0] = my::ticks_to_ms(my::clock_ticks() - t1);
+
+        t1 = my::clock_ticks();
+        my::bfs_farthest(G, s, parent);
+        std::vector<Vertex> route;
+        if (parent[t] != num_vertices(G))
         {
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_line(G, cases[c], edge_handles);
-            DynGraph DG(G);
-
-            // this will halve the line every time, making it
-            // the worst case for process A
-            std::queue<Vertex> vq;
-            int level = cases[c] / 4;
-            int limit = 1;
-            int limit_counter = 0;
-            vq.push(cases[c] / 2);
-            for (int q = 0; q < query_num; ++q)
+            for (Vertex w = t; w != s; w = parent[w])
             {
-                int current = vq.front();
-                vq.pop();
-
-                vq.push(current - level);
-                vq.push(current + level);
-
-                ++limit_counter;
-                if (limit_counter == limit)
-                {
-                    level /= 2;
-                    limit *= 2;
-                    limit_counter = 0;
-                }
-
-                std::chrono::duration<double, std::milli> dur(0);
-                Edge e = edge(current, current - 1, G).first;
-                Vertex src = source(e, G);
-                Vertex trgt = source(e, G);
-                remove_edge(e, G);
-                auto t1 = std::chrono::high_resolution_clock::now();
-                // now remove the edge
-                DG.reorg_after_remove(trgt, src);
-                auto t2 = std::chrono::high_resolution_clock::now();
-
-                // save total time for current case
-                res[c] += std::chrono::duration<double, std::milli>(t2 - t1).count();
+                route.push_back(w);
             }
+            route.push_back(s);
         }
-
-        // take avg over iterations
-        res[c] /= ITERATIONS;
+        times[q][1] = my::ticks_to_ms(my::clock_ticks() - t1);
+        assert(path.empty() == route.empty());
     }
-
-    return res;
 }
 
-std::vector<double> bench_worst_process_b(std::vector<int> &cases)
+std::vector<std::vector<long>> single_param_cases(const std::vector<int> &values)
 {
-    std::vector<double> res(cases.size(), 0.0);
-
-    for (int c = 0; c < cases.size(); ++c)
+    std::vector<std::vector<long>> cases;
+    for (auto it = values.begin(); it != values.end(); ++it)
     {
-
-        std::cout << cases[c] << std::endl;
-        assert(cases[c] > 0);
-
-        for (int iter = 0; iter < ITERATIONS; ++iter)
-        {
-            // construct new ring graph for every iteration
-            Graph G;
-            std::vector<Edge> edge_handles;
-            gen::generate_ring(G, cases[c], edge_handles);
-            DynGraph DG(G);
-
-            // will only remove one edge to cause worst-case restructuring with process B
-            std::chrono::duration<double, std::milli> dur(0);
-            // remove the edge before the random root to cause worst case scenario
-            Edge e = edge(DG.get_root(), (DG.get_root() - 1) % cases[c], G).first;
-            Vertex src = source(e, G);
-            Vertex trgt = target(e, G);
-            remove_edge(e, G);
-            auto t1 = std::chrono::high_resolution_clock::now();
-            // now remove the edge
-            DG.reorg_after_remove(trgt, src);
-            auto t2 = std::chrono::high_resolution_clock::now();
-
-            // save total time for current case
-            res[c] += std::chrono::duration<double, std::milli>(t2 - t1).count();
-        }
-
-        // take avg over iterations
-        res[c] /= ITERATIONS;
+        cases.push_back(std::vector<long>(1, *it));
     }
-
-    return res;
+    return cases;
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    std::vector<std::pair<int, int>> random_cases = {
+    bench::Config config;
+    bool list = false;
+    if (!bench::parse_args(argc, argv, config, list))
+    {
+        return 1;
+    }
+
+    std::vector<std::vector<long>> random_cases = {
         {500, 500},
         {500, 2000},
         {1500, 3000},
         {3000, 10000},
         {10000, 500},
     };
-    auto res_random = bench_random_q_queries(random_cases);
-    save_bench_to_file("../results/bench_random_q_queries", res_random, random_cases);
-
-    std::vector<int> line_log_cases = {256, 2048, 65536, 131072};
-    auto res_line_log = bench_line_q_queries(line_log_cases);
-    save_bench_to_file("../results/bench_line_q_queries", res_line_log, line_log_cases);
-
-    std::vector<int> line_random_cases = {4096, 16384};
-    auto res_line_random = bench_line_q_random_queries(line_random_cases);
-    save_bench_to_file("../results/bench_line_q_random_queries", res_line_random, line_random_cases);
-
-    std::vector<int> fully_conn_cases = {50, 100, 250};
-    auto res_fully_conn = bench_fully_connected_q_queries(fully_conn_cases);
-    save_bench_to_file("../results/bench_fully_connected_q_queries", res_fully_conn, fully_conn_cases);
-
-    std::vector<int> worst_a_cases = powers_of_two(10, 256);
-    auto res_worst_a = bench_worst_process_a(worst_a_cases);
-    save_worst_case_to_file("../results/worst_case_process_a_bench", res_worst_a, worst_a_cases);
 
-    std::vector<int> worst_b_cases = powers_of_two(6, 256);
-    auto res_worst_b = bench_worst_process_b(worst_b_cases);
-    save_worst_case_to_file("../results/worst_case_process_b_bench", res_worst_b, worst_b_cases);
-
-    std::vector<int> bench_ring_cases = {256, 2048, 16384};
-    auto res_ring = bench_ring_q_random_queries(bench_ring_cases);
-    save_bench_to_file("../results/bench_ring_q_queries", res_ring, bench_ring_cases);
+    // memory scaling by edge count, larger graphs (up to 10^8 edges) with --cases 10000000,100000000
+    std::vector<std::string> memory_columns = {"bytes_per_vertex", "bytes_per_edge", "graph_bytes_per_edge",
+                                               "edge_set_bytes_per_edge", "change_log_peak_bytes"};
+    std::vector<std::vector<long>> memory_cases = single_param_cases({10000, 100000, 1000000});
+
+    std::vector<bench::Suite> suites = {
+        {"random", "uniform random graph (vertices x edges), random deletions", {"reorg", "dfs"}, random_cases,
+         run_random_q_queries, bench::DatFormat::PerQuery, "bench_random_q_queries"},
+        {"line", "line graph, every deletion halves a segment (power of two vertices)", {"reorg", "dfs"},
+         single_param_cases({256, 2048, 65536, 131072}), run_line_q_queries, bench::DatFormat::PerQuery, "bench_line_q_queries"},
+        {"line_random", "line graph, random deletions", {"reorg", "dfs"}, single_param_cases({4096, 16384}),
+         run_line_q_random_queries, bench::DatFormat::PerQuery, "bench_line_q_random_queries"},
+        {"fully_connected", "complete graph, random deletions", {"reorg", "dfs"}, single_param_cases({50, 100, 250}),
+         run_fully_connected_q_queries, bench::DatFormat::PerQuery, "bench_fully_connected_q_queries"},
+        {"worst_a", "total reorganization time of the halving line, worst case for process A", {"reorg"},
+         single_param_cases(powers_of_two(10, 256)), run_worst_process_a, bench::DatFormat::Total, "worst_case_process_a_bench"},
+        {"worst_b", "ring, deleting the edge before the root, worst case for process B", {"reorg"},
+         single_param_cases(powers_of_two(6, 256)), run_worst_process_b, bench::DatFormat::Total, "worst_case_process_b_bench"},
+        {"adversarial_bumps", "ring of bundles (layers x width), cut next to the root, most level increases of process B",
+         {"reorg"}, {{64, 1}, {128, 1}, {256, 1}, {512, 1}, {32, 4}, {64, 4}, {128, 4}, {32, 16}, {64, 16}, {128, 16}},
+         run_adversarial_level_bumps, bench::DatFormat::Total, "adversarial_level_bumps"},
+        {"adversarial_race", "two bundles (layers x width) joined by a bridge, longest race of process A against B",
+         {"reorg"}, {{1024, 1}, {4096, 1}, {16384, 1}, {128, 8}, {512, 8}, {2048, 8}, {32, 32}, {128, 32}, {512, 32}},
+         run_adversarial_race, bench::DatFormat::Total, "adversarial_race"},
+        {"adversarial_halving", "line of cliques (segments x width) cut in halving order, most rewound work in total",
+         {"reorg"}, {{1024, 1}, {4096, 1}, {16384, 1}, {256, 8}, {1024, 8}, {4096, 8}, {64, 32}, {256, 32}, {1024, 32}},
+         run_adversarial_halving, bench::DatFormat::Total, "adversarial_halving"},
+        {"ring", "ring graph, random deletions", {"reorg", "dfs"}, single_param_cases({256, 2048, 16384}),
+         run_ring_q_random_queries, bench::DatFormat::PerQuery, "bench_ring_q_queries"},
+        {"engines", "random graphs, state machine against coroutine engine", {"state_machine", "coroutine"}, random_cases,
+         run_engines_random_q_queries, bench::DatFormat::PerQuery, "bench_engines_random_q_queries"},
+        {"offline", "random graphs, every edge deleted in random order, ES structure against offline union-find", {"es", "offline"},
+         random_cases, run_offline_q_queries, bench::DatFormat::Total, "bench_offline_total"},
+        {"rmat", "R-MAT graph (scale x edges), skewed degrees with hubs, sampled deletions", {"reorg", "dfs"},
+         {{12, 32768}, {14, 131072}, {16, 524288}}, run_rmat_q_queries, bench::DatFormat::PerQuery, "bench_rmat_q_queries"},
+        {"grid_2d", "square 2D grid (side), sampled deletions", {"reorg", "dfs"}, single_param_cases({64, 256}),
+         run_grid_2d_q_queries, bench::DatFormat::PerQuery, "bench_grid_2d_q_queries"},
+        {"grid_3d", "cubic 3D grid (side), sampled deletions", {"reorg", "dfs"}, single_param_cases({16, 32}),
+         run_grid_3d_q_queries, bench::DatFormat::PerQuery, "bench_grid_3d_q_queries"},
+        {"barabasi_albert", "preferential attachment (vertices x edges per vertex), sampled deletions", {"reorg", "dfs"},
+         {{10000, 2}, {10000, 8}, {100000, 4}}, run_barabasi_albert_q_queries, bench::DatFormat::PerQuery,
+         "bench_barabasi_albert_q_queries"},
+        {"endpoints", "preferential attachment (vertices x edges per vertex), deletion by endpoints with edge() or the index",
+         {"edge_lookup", "edge_index"}, {{10000, 8}, {100000, 4}, {100000, 16}}, run_endpoints_q_queries,
+         bench::DatFormat::PerQuery, "bench_endpoints_q_queries"},
+        {"reorder", "R-MAT graph (scale x edges), sampled deletions under the identity, BFS, RCM and degree vertex orders",
+         {"identity", "bfs", "rcm", "degree"}, {{16, 524288}, {18, 2097152}}, run_reorder_q_queries,
+         bench::DatFormat::PerQuery, "bench_reorder_q_queries"},
+        {"memory_policy", "random graph (vertices x edges), sampled deletions with the per-vertex arrays on the heap, on "
+                          "transparent or explicit huge pages, interleaved over the NUMA nodes, or file backed",
+         {"heap", "transparent", "explicit", "interleave", "file"}, {{100000, 400000}, {1000000, 4000000}},
+         run_memory_policy_q_queries, bench::DatFormat::PerQuery, "bench_memory_policy_q_queries"},
+        {"paths", "random graph (vertices x edges), sampled deletions, path to a random vertex from the ES tree or a BFS",
+         {"connecting_path", "bfs"}, {{10000, 40000}, {100000, 400000}}, run_paths_q_queries, bench::DatFormat::PerQuery,
+         "bench_paths_q_queries"},
+        {"sbm", "stochastic block model (vertices x blocks), degree 8 inside and 1 across blocks, sampled deletions",
+         {"reorg", "dfs"}, {{10000, 10}, {100000, 100}}, run_sbm_q_queries, bench::DatFormat::PerQuery, "bench_sbm_q_queries"},
+        {"memory_random", "memory footprint of random graphs with average degree 8, by edge count", memory_columns, memory_cases,
+         run_memory_random, bench::DatFormat::Total, "memory_random", true, "B"},
+        {"memory_line", "memory footprint of line graphs, by edge count", memory_columns, memory_cases, run_memory_line,
+         bench::DatFormat::Total, "memory_line", true, "B"},
+        {"memory_ring", "memory footprint of ring graphs, by edge count", memory_columns, memory_cases, run_memory_ring,
+         bench::DatFormat::Total, "memory_ring", true, "B"},
+        {"memory_fully_connected", "memory footprint of complete graphs, by edge count", memory_columns, memory_cases,
+         run_memory_fully_connected, bench::DatFormat::Total, "memory_fully_connected", true, "B"},
+        {"memory_rmat", "memory footprint of R-MAT graphs, by edge count", memory_columns, memory_cases, run_memory_rmat,
+         bench::DatFormat::Total, "memory_rmat", true, "B"},
+    };
 
-    return 0;
+    if (list)
+    {
+        bench::print_suites(suites);
+        return 0;
+    }
+    return bench::run(config, suites);
 }
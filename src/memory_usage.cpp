@@ -0,0 +1,16 @@
+#include "memory_usage.hpp"
+#include <algorithm>
+
+std::size_t my::MemoryUsage::total() const
+{
+    return graph + levels + components + alpha + beta + gamma + change_log_peak + edge_index;
+}
+
+std::size_t my::allocation_bytes(std::size_t request)
+{
+    if (request == 0)
+    {
+        return 0;
+    }
+    return std::max<std::size_t>(32, (request + sizeof(std::size_t) + 15) & ~static_cast<std::size_t>(15));
+}
@@ -0,0 +1,147 @@
+#include "offline_dyn_graph.hpp"
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace boost;
+
+namespace
+{
+    std::uint64_t edge_key(Vertex u, Vertex v, std::size_t n)
+    {
+        // undirected, the smaller endpoint first
+        if (v < u)
+        {
+            std::swap(u, v);
+        }
+        return static_cast<std::uint64_t>(u) * n + v;
+    }
+}
+
+OfflineDynGraph::OfflineDynGraph(Graph &G, const std::vector<std::pair<Vertex, Vertex>> &deletions)
+    : _G(G), _deletions(deletions), _step(0)
+{
+    std::size_t n = num_vertices(_G);
+    std::size_t k = _deletions.size();
+    _parent.resize(n);
+    _rank.assign(n, 0);
+    _link_step.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        _parent[i] = i;
+    }
+
+    // the graph may have parallel edges, so count how many copies of every edge get deleted
+    std::unordered_map<std::uint64_t, std::size_t> deleted;
+    deleted.reserve(k);
+    for (auto it = _deletions.begin(); it != _deletions.end(); ++it)
+    {
+        ++deleted[edge_key(it->first, it->second, n)];
+    }
+
+    // edges that are never deleted are present at every step
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(_G); ei != eiend; ++ei)
+    {
+        Vertex u = source(*ei, _G);
+        Vertex v = target(*ei, _G);
+        auto found = deleted.find(edge_key(u, v, n));
+        if (found != deleted.end() && found->second > 0)
+        {
+            --found->second;
+            continue;
+        }
+        _link(u, v, k);
+    }
+    for (auto it = deleted.begin(); it != deleted.end(); ++it)
+    {
+        assert(it->second == 0 && "Every deletion has to be an edge of the graph.");
+    }
+
+    // the i-th deletion is present until step i, inserting in reverse keeps the link steps decreasing towards the roots
+    for (std::size_t i = k; i-- > 0;)
+    {
+        _link(_deletions[i].first, _deletions[i].second, i);
+    }
+}
+
+void OfflineDynGraph::_link(Vertex a, Vertex b, std::size_t step)
+{
+    // step 0 is the oldest, every link is present then
+    Vertex ra = _find_at(a, 0);
+    Vertex rb = _find_at(b, 0);
+    if (ra == rb)
+    {
+        return;
+    }
+    // union by rank keeps the trees O(log n) high, no path compression so the link steps stay intact
+    if (_rank[ra] < _rank[rb])
+    {
+        std::swap(ra, rb);
+    }
+    _parent[rb] = ra;
+    _link_step[rb] = step;
+    if (_rank[ra] == _rank[rb])
+    {
+        ++_rank[ra];
+    }
+}
+
+Vertex OfflineDynGraph::_find_at(Vertex x, std::size_t step)
+{
+    // links are made in decreasing step order, so once a link is gone all links above it are gone too
+    while (_parent[x] != x && _link_step[x] >= step)
+    {
+        x = _parent[x];
+    }
+    return x;
+}
+
+void OfflineDynGraph::dyn_remove_edge(Edge e)
+{
+    Vertex v = source(e, _G);
+    Vertex u = target(e, _G);
+    remove_edge(e, _G);
+    reorg_after_remove(v, u);
+}
+
+void OfflineDynGraph::reorg_after_remove(Vertex v, Vertex u)
+{
+    assert(_step < _deletions.size() && "More deletions than given upfront.");
+    const std::pair<Vertex, Vertex> &next = _deletions[_step];
+    assert(((next.first == v && next.second == u) || (next.first == u && next.second == v)) &&
+           "Deletions have to follow the sequence given upfront.");
+    ++_step;
+}
+
+bool OfflineDynGraph::query_is_connected(Vertex v, Vertex u)
+{
+    return query_is_connected_at(_step, v, u);
+}
+
+bool OfflineDynGraph::query_is_connected(Edge e)
+{
+    return query_is_connected_at(_step, source(e, _G), target(e, _G));
+}
+
+bool OfflineDynGraph::query_is_connected_at(std::size_t step, Vertex v, Vertex u)
+{
+    assert(step <= _deletions.size());
+    return _find_at(v, step) == _find_at(u, step);
+}
+
+bool OfflineDynGraph::deletion_breaks(std::size_t step)
+{
+    assert(step < _deletions.size());
+    return !query_is_connected_at(step + 1, _deletions[step].first, _deletions[step].second);
+}
+
+std::size_t OfflineDynGraph::current_step()
+{
+    return _step;
+}
+
+std::size_t OfflineDynGraph::num_steps()
+{
+    return _deletions.size();
+}
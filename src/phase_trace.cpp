@@ -0,0 +1,111 @@
+#include "phase_trace.hpp"
+#include "latency.hpp"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    const char *track_name(my::PhaseTracer::Track track)
+    {
+        switch (track)
+        {
+        case my::PhaseTracer::ProcessA:
+            return "process A";
+        case my::PhaseTracer::ProcessB:
+            return "process B";
+        case my::PhaseTracer::Deletions:
+        default:
+            return "deletions";
+        }
+    }
+}
+
+my::PhaseTracer::PhaseTracer(const std::string &path, std::size_t max_events)
+    : _out(path, std::ios::out | std::ios::trunc), _max_events(max_events), _dropped(0), _origin(clock_ticks())
+{
+    // calibrate now rather than on close, the calibration takes a few milliseconds
+    ticks_per_ns();
+}
+
+my::PhaseTracer::~PhaseTracer()
+{
+    close();
+}
+
+bool my::PhaseTracer::is_open()
+{
+    return _out.is_open() && _out.good();
+}
+
+void my::PhaseTracer::complete(const char *name, Track track, std::uint64_t start, std::uint64_t end,
+                               std::initializer_list<PhaseArg> args)
+{
+    if (_events.size() >= _max_events)
+    {
+        ++_dropped;
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.track = track;
+    event.start = start;
+    event.end = end;
+    event.num_args = std::min<int>(args.size(), MAX_ARGS);
+    std::copy(args.begin(), args.begin() + event.num_args, event.args);
+    _events.push_back(event);
+}
+
+std::size_t my::PhaseTracer::size()
+{
+    return _events.size();
+}
+
+std::size_t my::PhaseTracer::dropped()
+{
+    return _dropped;
+}
+
+bool my::PhaseTracer::close()
+{
+    if (!_out.is_open())
+    {
+        return true;
+    }
+    // timestamps and durations are in microseconds, with nanosecond digits
+    _out << std::fixed << std::setprecision(3);
+    _out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << _dropped << "},\"traceEvents\":[\n";
+    const Track tracks[3] = {Deletions, ProcessA, ProcessB};
+    for (int i = 0; i < 3; ++i)
+    {
+        _out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << tracks[i] << ",\"name\":\"thread_name\",\"args\":{\"name\":\""
+             << track_name(tracks[i]) << "\"}},\n";
+        _out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << tracks[i] << ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":"
+             << tracks[i] << "}},\n";
+    }
+    _out << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"DynGraph\"}}";
+    for (auto it = _events.begin(); it != _events.end(); ++it)
+    {
+        // events may have been recorded before the origin by a caller that read the clock first
+        double ts = ticks_to_ns(it->start > _origin ? it->start - _origin : 0) / 1000.0;
+        double dur = ticks_to_ns(it->end > it->start ? it->end - it->start : 0) / 1000.0;
+        _out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << it->track << ",\"name\":\"" << it->name << "\",\"ts\":" << ts
+             << ",\"dur\":" << dur;
+        if (it->num_args > 0)
+        {
+            _out << ",\"args\":{";
+            for (int a = 0; a < it->num_args; ++a)
+            {
+                _out << (a > 0 ? "," : "") << "\"" << it->args[a].name << "\":" << it->args[a].value;
+            }
+            _out << "}";
+        }
+        _out << "}";
+    }
+    _out << "\n]}\n";
+    _out.flush();
+    bool ok = _out.good();
+    _out.close();
+    _events.clear();
+    _events.shrink_to_fit();
+    return ok;
+}
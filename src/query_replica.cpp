@@ -0,0 +1,55 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "shared_components.hpp"
+
+// query_replica answers connectivity queries from a segment published with DynGraph::start_publishing, in a process of its
+// own. It reads vertex pairs "u v" from the standard input and prints 1 if they are connected and 0 if not, one line each.
+// It exits with an error if the writer died in the middle of an update.
+
+void usage(const char *prog)
+{
+    std::cerr << "usage: " << prog << " NAME [--stats]\n"
+              << "  NAME                   shared memory segment, as given to DynGraph::start_publishing\n"
+              << "  --stats                print the vertex count and the deletions published so far, then exit\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3 || (argc == 3 && std::string(argv[2]) != "--stats"))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    my::SharedComponentsReader reader;
+    std::string error;
+    if (!reader.open(argv[1], error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (argc == 3)
+    {
+        std::cout << reader.num_vertices() << " vertices, " << reader.deletions() << " deletions"
+                  << (reader.has_levels() ? ", with levels" : "") << std::endl;
+        return 0;
+    }
+
+    std::size_t u, v;
+    while (std::cin >> u >> v)
+    {
+        if (u >= reader.num_vertices() || v >= reader.num_vertices())
+        {
+            std::cerr << "vertex out of range: " << u << " " << v << std::endl;
+            return 1;
+        }
+        bool connected = false;
+        if (!reader.query_is_connected(u, v, connected))
+        {
+            std::cerr << "the writer died in the middle of an update" << std::endl;
+            return 1;
+        }
+        std::cout << connected << '\n';
+    }
+    return 0;
+}
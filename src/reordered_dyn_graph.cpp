@@ -0,0 +1,169 @@
+#include "reordered_dyn_graph.hpp"
+#include "algo.hpp"
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <utility>
+#include <boost/graph/cuthill_mckee_ordering.hpp>
+
+using namespace boost;
+
+std::vector<Vertex> my::vertex_order(const Graph &G, VertexOrder order)
+{
+    std::size_t n = num_vertices(G);
+    std::vector<Vertex> new_id(n);
+    // visit[i] is the original id of the vertex numbered i
+    std::vector<Vertex> visit;
+    visit.reserve(n);
+
+    switch (order)
+    {
+    case VertexOrder::Bfs:
+    {
+        // start every component from its highest degree vertex, the hub is where most traversals pass
+        std::vector<Vertex> by_degree(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            by_degree[i] = i;
+        }
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&G](Vertex a, Vertex b)
+                         { return out_degree(a, G) > out_degree(b, G); });
+        std::vector<bool> seen(n, false);
+        for (auto s = by_degree.begin(); s != by_degree.end(); ++s)
+        {
+            if (seen[*s])
+            {
+                continue;
+            }
+            std::queue<Vertex> vq;
+            vq.push(*s);
+            seen[*s] = true;
+            while (!vq.empty())
+            {
+                Vertex v = vq.front();
+                vq.pop();
+                visit.push_back(v);
+                OutEdgeIterator oei, oeiend;
+                for (tie(oei, oeiend) = out_edges(v, G); oei != oeiend; ++oei)
+                {
+                    Vertex w = target(*oei, G);
+                    if (!seen[w])
+                    {
+                        seen[w] = true;
+                        vq.push(w);
+                    }
+                }
+            }
+        }
+        break;
+    }
+    case VertexOrder::ReverseCuthillMcKee:
+    {
+        // boost finds a pseudo-peripheral start vertex in every component
+        std::vector<default_color_type> colors(n);
+        visit.resize(n);
+        cuthill_mckee_ordering(G, visit.rbegin(), make_iterator_property_map(colors.begin(), get(vertex_index, G)),
+                               make_degree_map(G));
+        break;
+    }
+    case VertexOrder::Degree:
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            visit.push_back(i);
+        }
+        std::stable_sort(visit.begin(), visit.end(), [&G](Vertex a, Vertex b)
+                         { return out_degree(a, G) > out_degree(b, G); });
+        break;
+    }
+    case VertexOrder::Identity:
+    default:
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            visit.push_back(i);
+        }
+        break;
+    }
+
+    assert(visit.size() == n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        new_id[visit[i]] = i;
+    }
+    return new_id;
+}
+
+void my::relabel_graph(const Graph &G, const std::vector<Vertex> &new_id, Graph &H)
+{
+    assert(num_vertices(H) == 0 && new_id.size() == num_vertices(G));
+    std::vector<std::pair<Vertex, Vertex>> edge_list;
+    edge_list.reserve(num_edges(G));
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(G); ei != eiend; ++ei)
+    {
+        Vertex u = new_id[source(*ei, G)];
+        Vertex v = new_id[target(*ei, G)];
+        edge_list.push_back(std::make_pair(std::min(u, v), std::max(u, v)));
+    }
+    std::sort(edge_list.begin(), edge_list.end());
+    Graph relabeled(edge_list.begin(), edge_list.end(), num_vertices(G));
+    H.swap(relabeled);
+}
+
+ReorderedDynGraph::ReorderedDynGraph(const Graph &G, VertexOrder order, Vertex root)
+{
+    _relabel(G, order);
+    _DG.reset(new DynGraph(_H, _new_id[root]));
+}
+
+ReorderedDynGraph::ReorderedDynGraph(const Graph &G, VertexOrder order, RootStrategy strategy)
+{
+    _relabel(G, order);
+    _DG.reset(new DynGraph(_H, strategy));
+}
+
+void ReorderedDynGraph::_relabel(const Graph &G, VertexOrder order)
+{
+    _new_id = my::vertex_order(G, order);
+    _old_id.resize(_new_id.size());
+    for (std::size_t i = 0; i < _new_id.size(); ++i)
+    {
+        _old_id[_new_id[i]] = i;
+    }
+    my::relabel_graph(G, _new_id, _H);
+}
+
+bool ReorderedDynGraph::dyn_remove_edge(Vertex u, Vertex v)
+{
+    return _DG->dyn_remove_edge(_new_id[u], _new_id[v]);
+}
+
+bool ReorderedDynGraph::query_is_connected(Vertex u, Vertex v)
+{
+    return _DG->query_is_connected(_new_id[u], _new_id[v]);
+}
+
+Vertex ReorderedDynGraph::get_root()
+{
+    return _old_id[_DG->get_root()];
+}
+
+Vertex ReorderedDynGraph::to_internal(Vertex v)
+{
+    return _new_id[v];
+}
+
+Vertex ReorderedDynGraph::to_external(Vertex v)
+{
+    return _old_id[v];
+}
+
+const Graph &ReorderedDynGraph::graph()
+{
+    return _H;
+}
+
+DynGraph &ReorderedDynGraph::dyn_graph()
+{
+    return *_DG;
+}
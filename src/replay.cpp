@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "dyn_graph.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
+
+using namespace boost;
+
+// replay_trace repeats a workload recorded with DynGraph::start_trace on the same graph, root, settings and deletion
+// sequence, checks that every deletion has the recorded outcome, and reports the reorganization times
+
+void usage(const char *prog)
+{
+    std::cerr << "usage: " << prog << " TRACE [options]\n"
+              << "  --engine NAME          state_machine or coroutine (default: the recorded engine)\n"
+              << "  --repeat N             replays of the trace, the slowest deletions are ranked by their fastest run (default: 1)\n"
+              << "  --top K                number of slowest deletions to list (default: 10)\n"
+              << "  --phase-trace FILE     write the phases of the first run as a Chrome trace to FILE\n"
+              << "  --state-dir DIR        keep the per-vertex arrays in files under DIR, for state larger than RAM\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string path = argv[1];
+    std::string engine_name;
+    int repeat = 1;
+    int top = 10;
+    std::string phase_path;
+    my::MemoryPolicy memory;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine")
+        {
+            engine_name = value;
+        }
+        else if (arg == "--repeat")
+        {
+            repeat = std::atoi(value.c_str());
+        }
+        else if (arg == "--top")
+        {
+            top = std::atoi(value.c_str());
+        }
+        else if (arg == "--phase-trace")
+        {
+            phase_path = value;
+        }
+        else if (arg == "--state-dir")
+        {
+            memory.directory = value;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (repeat < 1 || top < 0 || (!engine_name.empty() && engine_name != "state_machine" && engine_name != "coroutine"))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    my::WorkloadTrace trace;
+    std::string error;
+    if (!my::read_trace(path, trace, error))
+    {
+        std::cerr << path << ": " << error << std::endl;
+        return 1;
+    }
+    // read_trace has rejected engines this build does not know
+    ReorgEngine engine = static_cast<ReorgEngine>(trace.engine);
+    if (!engine_name.empty())
+    {
+        engine = (engine_name == "coroutine") ? ReorgEngine::Coroutine : ReorgEngine::StateMachine;
+    }
+    std::cout << path << ": " << trace.num_vertices << " vertices, " << trace.edges.size() << " edges, root " << trace.root
+              << ", " << trace.deletions.size() << " deletions" << std::endl;
+
+    // fastest time of every deletion over all repeats
+    std::vector<std::uint64_t> best(trace.deletions.size(), UINT64_MAX);
+    my::LatencyHistogram all;
+    for (int r = 0; r < repeat; ++r)
+    {
+        Graph G;
+        my::build_graph(trace, G);
+        if (my::graph_fingerprint(G) != trace.fingerprint)
+        {
+            std::cerr << "graph fingerprint mismatch, the trace is corrupt" << std::endl;
+            return 1;
+        }
+        DynGraph DG(G, trace.root, memory);
+        DG.set_engine(engine);
+        DG.apply_trace_settings(trace.settings);
+        if (r == 0 && !phase_path.empty() && !DG.start_phase_trace(phase_path))
+        {
+            std::cerr << "cannot write " << phase_path << std::endl;
+            return 1;
+        }
+
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < trace.deletions.size(); ++i)
+        {
+            const my::TraceDeletion &d = trace.deletions[i];
+            // dyn_remove_edge(u, v) reorganizes as reorg_after_remove(v, u), the recorded order
+            if (!DG.dyn_remove_edge(d.u, d.v))
+            {
+                std::cerr << "deletion " << i << ": no edge (" << d.v << ", " << d.u << ") left" << std::endl;
+                return 1;
+            }
+            if (DG.query_is_connected(d.v, d.u) == d.breaks)
+            {
+                std::cerr << "deletion " << i << ": outcome differs from the recorded one" << std::endl;
+                return 1;
+            }
+            best[i] = std::min(best[i], DG.last_reorg_ticks());
+            total += DG.last_reorg_ticks();
+        }
+        all += DG.reorg_latency();
+        if (r == 0 && !phase_path.empty() && !DG.stop_phase_trace())
+        {
+            std::cerr << "writing " << phase_path << " failed" << std::endl;
+            return 1;
+        }
+        std::cout << "run " << r << ": " << my::ticks_to_ms(total) << " ms" << std::endl;
+    }
+
+    std::cout << "reorg: p50 " << my::ticks_to_ms(all.percentile(50)) << " p99 " << my::ticks_to_ms(all.percentile(99))
+              << " p99.9 " << my::ticks_to_ms(all.percentile(99.9)) << " max " << my::ticks_to_ms(all.max()) << " ms" << std::endl;
+
+    std::vector<std::size_t> order(trace.deletions.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::size_t shown = std::min<std::size_t>(top, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+                      [&best](std::size_t a, std::size_t b)
+                      { return best[a] > best[b]; });
+    for (std::size_t k = 0; k < shown; ++k)
+    {
+        const my::TraceDeletion &d = trace.deletions[order[k]];
+        std::cout << "  deletion " << order[k] << " (" << d.v << ", " << d.u << ")" << (d.breaks ? " breaks" : "") << ": "
+                  << my::ticks_to_ms(best[order[k]]) << " ms" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// weight of the newest sample in the moving averages, roughly the last 16 deletions are remembered
+#define SCHEDULER_EMA_WEIGHT 0.0625
+
+my::StepScheduler::StepScheduler() : StepScheduler(1, 1, 1)
+{
+}
+
+my::StepScheduler::StepScheduler(int quantum, int ratio_a, int ratio_b, SchedulePolicy policy, int max_ratio)
+    : _quantum(quantum), _ratio_a(ratio_a), _ratio_b(ratio_b), _max_ratio(max_ratio), _policy(policy),
+      _a_win_ema(0.5), _small_size_ema(0.0)
+{
+    assert(quantum > 0 && ratio_a > 0 && ratio_b > 0 && max_ratio > 0);
+    // the ratio bound is what keeps the worst case, so it also applies to the fixed ratios given here
+    _ratio_a = std::min(_ratio_a, _max_ratio);
+    _ratio_b = std::min(_ratio_b, _max_ratio);
+}
+
+int my::StepScheduler::steps_a() const
+{
+    return _quantum * _ratio_a;
+}
+
+int my::StepScheduler::steps_b() const
+{
+    return _quantum * _ratio_b;
+}
+
+int my::StepScheduler::branch_quantum() const
+{
+    if (_policy == SchedulePolicy::Fixed)
+    {
+        return _quantum;
+    }
+    // the branch that loses the race wastes at most one turn, so small turns pay off when the broken off components are small.
+    // Larger components can afford longer turns and fewer branch switches.
+    int q = static_cast<int>(_small_size_ema / 8.0);
+    return std::max(1, std::min(q, _quantum));
+}
+
+void my::StepScheduler::record(bool a_won, std::size_t small_size)
+{
+    if (_policy == SchedulePolicy::Fixed)
+    {
+        return;
+    }
+
+    _a_win_ema += SCHEDULER_EMA_WEIGHT * ((a_won ? 1.0 : 0.0) - _a_win_ema);
+    if (a_won)
+    {
+        _small_size_ema += SCHEDULER_EMA_WEIGHT * (static_cast<double>(small_size) - _small_size_ema);
+    }
+    _adapt();
+}
+
+void my::StepScheduler::_adapt()
+{
+    // favour the process that has been deciding recent deletions, in proportion to the odds of it winning again.
+    // The ratio is clamped to max_ratio so that the other process keeps a constant share of the steps.
+    double w = std::min(std::max(_a_win_ema, 1e-6), 1.0 - 1e-6);
+    if (w >= 0.5)
+    {
+        _ratio_a = std::min(_max_ratio, static_cast<int>(std::lround(w / (1.0 - w))));
+        _ratio_b = 1;
+    }
+    else
+    {
+        _ratio_a = 1;
+        _ratio_b = std::min(_max_ratio, static_cast<int>(std::lround((1.0 - w) / w)));
+    }
+}
+
+double my::StepScheduler::a_win_rate() const
+{
+    return _a_win_ema;
+}
+
+double my::StepScheduler::avg_small_size() const
+{
+    return _small_size_ema;
+}
+
+void my::StepScheduler::restore_averages(double a_win_rate, double avg_small_size)
+{
+    _a_win_ema = a_win_rate;
+    _small_size_ema = avg_small_size;
+}
+
+int my::StepScheduler::quantum() const
+{
+    return _quantum;
+}
+
+int my::StepScheduler::ratio_a() const
+{
+    return _ratio_a;
+}
+
+int my::StepScheduler::ratio_b() const
+{
+    return _ratio_b;
+}
+
+int my::StepScheduler::max_ratio() const
+{
+    return _max_ratio;
+}
+
+my::SchedulePolicy my::StepScheduler::policy() const
+{
+    return _policy;
+}
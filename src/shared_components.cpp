@@ -0,0 +1,306 @@
+#include "shared_components.hpp"
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const std::size_t HEADER_SIZE = 64;
+    // attempts of a reader between two checks that the writer is alive, once it yields the core on every attempt
+    const int WRITER_CHECK_INTERVAL = 1024;
+    static_assert(sizeof(my::SharedComponentsHeader) <= HEADER_SIZE, "the header has to fit in its padding");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the sequence lock has to work across processes");
+
+    std::size_t segment_length(std::size_t num_vertices, bool with_levels)
+    {
+        return HEADER_SIZE + (with_levels ? 2 : 1) * num_vertices * sizeof(int);
+    }
+
+    // the entries are read by other processes while they are written, every access is atomic. atomic_ref needs a
+    // non const object, the reader only loads through it.
+    int load_entry(const int *a, std::size_t i)
+    {
+        return std::atomic_ref<int>(const_cast<int &>(a[i])).load(std::memory_order_relaxed);
+    }
+
+    void store_entry(int *a, std::size_t i, int value)
+    {
+        std::atomic_ref<int>(a[i]).store(value, std::memory_order_relaxed);
+    }
+}
+
+my::SharedComponentsWriter::SharedComponentsWriter()
+    : _base(nullptr), _length(0), _header(nullptr), _components(nullptr), _levels(nullptr)
+{
+}
+
+my::SharedComponentsWriter::~SharedComponentsWriter()
+{
+    close();
+}
+
+bool my::SharedComponentsWriter::create(const std::string &name, std::size_t num_vertices, bool with_levels,
+                                        std::string &error)
+{
+    close();
+    // a segment left behind by a writer that died is replaced, readers still holding it keep the old one
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        error = "cannot create shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    std::size_t length = segment_length(num_vertices, with_levels);
+    if (ftruncate(fd, length) != 0)
+    {
+        error = "cannot size shared memory " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        error = "cannot map shared memory " + name + ": " + std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    _name = name;
+    _base = base;
+    _length = length;
+    // the object is zero filled, the header is constructed in place
+    _header = new (base) SharedComponentsHeader();
+    _components = reinterpret_cast<int *>(static_cast<char *>(base) + HEADER_SIZE);
+    _levels = with_levels ? _components + num_vertices : nullptr;
+    _header->version = SHARED_COMPONENTS_VERSION;
+    _header->has_levels = with_levels;
+    _header->num_vertices = num_vertices;
+    _header->seq.store(0, std::memory_order_relaxed);
+    _header->deletions.store(0, std::memory_order_relaxed);
+    _header->writer_pid = getpid();
+    // readers check the magic last, once it is there the rest of the header is
+    std::atomic_ref<std::uint64_t>(_header->magic).store(SHARED_COMPONENTS_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool my::SharedComponentsWriter::has_levels()
+{
+    return _levels != nullptr;
+}
+
+void my::SharedComponentsWriter::begin()
+{
+    // odd while the update is in progress, the fence keeps the entry stores after it
+    _header->seq.store(_header->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void my::SharedComponentsWriter::set_component(std::size_t v, int component)
+{
+    assert(v < _header->num_vertices);
+    store_entry(_components, v, component);
+}
+
+void my::SharedComponentsWriter::set_level(std::size_t v, int level)
+{
+    assert(v < _header->num_vertices && _levels);
+    store_entry(_levels, v, level);
+}
+
+void my::SharedComponentsWriter::end()
+{
+    _header->seq.store(_header->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void my::SharedComponentsWriter::publish_all(const int *components, const int *levels)
+{
+    begin();
+    for (std::size_t v = 0; v < _header->num_vertices; ++v)
+    {
+        store_entry(_components, v, components[v]);
+    }
+    if (_levels && levels)
+    {
+        for (std::size_t v = 0; v < _header->num_vertices; ++v)
+        {
+            store_entry(_levels, v, levels[v]);
+        }
+    }
+    end();
+}
+
+void my::SharedComponentsWriter::set_deletions(std::uint64_t deletions)
+{
+    _header->deletions.store(deletions, std::memory_order_release);
+}
+
+void my::SharedComponentsWriter::close()
+{
+    if (!_base)
+    {
+        return;
+    }
+    munmap(_base, _length);
+    shm_unlink(_name.c_str());
+    _base = nullptr;
+    _header = nullptr;
+    _components = nullptr;
+    _levels = nullptr;
+}
+
+my::SharedComponentsReader::SharedComponentsReader()
+    : _base(nullptr), _length(0), _header(nullptr), _components(nullptr), _levels(nullptr)
+{
+}
+
+my::SharedComponentsReader::~SharedComponentsReader()
+{
+    close();
+}
+
+bool my::SharedComponentsReader::open(const std::string &name, std::string &error)
+{
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        error = "cannot open shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < HEADER_SIZE)
+    {
+        error = name + " is not a components segment";
+        ::close(fd);
+        return false;
+    }
+    std::size_t length = st.st_size;
+    void *base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        error = "cannot map shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const SharedComponentsHeader *header = static_cast<const SharedComponentsHeader *>(base);
+    std::atomic_ref<std::uint64_t> magic(const_cast<std::uint64_t &>(header->magic));
+    if (magic.load(std::memory_order_acquire) != SHARED_COMPONENTS_MAGIC || header->version != SHARED_COMPONENTS_VERSION ||
+        segment_length(header->num_vertices, header->has_levels) != length)
+    {
+        error = name + " is not a components segment of version " + std::to_string(SHARED_COMPONENTS_VERSION);
+        munmap(base, length);
+        return false;
+    }
+    _base = base;
+    _length = length;
+    _header = header;
+    _components = reinterpret_cast<const int *>(static_cast<const char *>(base) + HEADER_SIZE);
+    _levels = header->has_levels ? _components + header->num_vertices : nullptr;
+    return true;
+}
+
+std::size_t my::SharedComponentsReader::num_vertices()
+{
+    return _header->num_vertices;
+}
+
+bool my::SharedComponentsReader::has_levels()
+{
+    return _levels != nullptr;
+}
+
+bool my::SharedComponentsReader::_read_pair(const int *a, std::size_t x, std::size_t y, int &ax, int &ay)
+{
+    assert(x < _header->num_vertices && y < _header->num_vertices);
+    for (int attempt = 0;; ++attempt)
+    {
+        std::uint64_t s1 = _header->seq.load(std::memory_order_acquire);
+        if ((s1 & 1) == 0)
+        {
+            ax = load_entry(a, x);
+            ay = load_entry(a, y);
+            // the fence keeps the entry loads before the second read of seq
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_header->seq.load(std::memory_order_relaxed) == s1)
+            {
+                return true;
+            }
+        }
+        if (attempt >= 64)
+        {
+            // a whole publish is running, give the writer the core
+            std::this_thread::yield();
+        }
+        // an update that is still running after that long may have lost its writer, which nothing would ever end. EPERM
+        // means the process exists under another user.
+        if (attempt % WRITER_CHECK_INTERVAL == WRITER_CHECK_INTERVAL - 1 && (s1 & 1) != 0 &&
+            kill(_header->writer_pid, 0) != 0 && errno == ESRCH && _header->seq.load(std::memory_order_acquire) == s1)
+        {
+            return false;
+        }
+    }
+}
+
+bool my::SharedComponentsReader::query_is_connected(std::size_t u, std::size_t v, bool &connected)
+{
+    int cu, cv;
+    if (!_read_pair(_components, u, v, cu, cv))
+    {
+        return false;
+    }
+    connected = cu == cv;
+    return true;
+}
+
+int my::SharedComponentsReader::component(std::size_t v)
+{
+    int c, unused;
+    if (!_read_pair(_components, v, v, c, unused))
+    {
+        return -1;
+    }
+    return c;
+}
+
+int my::SharedComponentsReader::level(std::size_t v)
+{
+    if (!_levels)
+    {
+        return -1;
+    }
+    int l, unused;
+    if (!_read_pair(_levels, v, v, l, unused))
+    {
+        return -1;
+    }
+    return l;
+}
+
+std::uint64_t my::SharedComponentsReader::deletions()
+{
+    return _header->deletions.load(std::memory_order_acquire);
+}
+
+void my::SharedComponentsReader::close()
+{
+    if (!_base)
+    {
+        return;
+    }
+    munmap(_base, _length);
+    _base = nullptr;
+    _header = nullptr;
+    _components = nullptr;
+    _levels = nullptr;
+}
@@ -0,0 +1,42 @@
+#include "spanning_forest.hpp"
+#include <cassert>
+
+Vertex my::tree_parent(my::StateVector<EdgeSet> &alpha, Vertex v)
+{
+    assert(!alpha[v].empty());
+    return alpha[v].other_end(alpha[v].begin(), v);
+}
+
+SpanningForestIterator::SpanningForestIterator(my::StateVector<EdgeSet> &alpha, Vertex v) : _alpha(&alpha), _v(v)
+{
+    _skip();
+}
+
+SpanningForestIterator &SpanningForestIterator::operator++()
+{
+    ++_v;
+    _skip();
+    return *this;
+}
+
+void SpanningForestIterator::_skip()
+{
+    while (_v < _alpha->size() && (*_alpha)[_v].empty())
+    {
+        ++_v;
+    }
+    if (_v < _alpha->size())
+    {
+        _edge = std::make_pair(_v, my::tree_parent(*_alpha, _v));
+    }
+}
+
+SpanningForestIterator SpanningForest::begin()
+{
+    return SpanningForestIterator(_alpha, 0);
+}
+
+SpanningForestIterator SpanningForest::end()
+{
+    return SpanningForestIterator(_alpha, _alpha.size());
+}
@@ -0,0 +1,369 @@
+#include "state_allocator.hpp"
+#include "memory_usage.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <linux/mempolicy.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    // nodes the masks passed to mbind can name
+    const int MAX_NODES = 1024;
+    const std::size_t MASK_WORDS = MAX_NODES / (8 * sizeof(unsigned long));
+
+    std::atomic<std::size_t> mapped_regions(0);
+    std::atomic<std::size_t> mapped_bytes(0);
+    std::atomic<std::size_t> huge_tlb_regions(0);
+    std::atomic<std::size_t> explicit_fallbacks(0);
+    std::atomic<std::size_t> numa_failures(0);
+    std::atomic<std::size_t> created_files(0);
+
+    // arenas by id, slot 0 is never used. Lookups only load a slot, registering takes the mutex.
+    std::atomic<my::RegionArena *> arenas[my::MAX_ARENAS];
+    std::mutex arenas_mutex;
+
+    std::size_t page_size(const my::MemoryPolicy &policy)
+    {
+        if (policy.pages == my::PagePolicy::Default || !policy.directory.empty())
+        {
+            return sysconf(_SC_PAGESIZE);
+        }
+        return my::HUGE_PAGE_SIZE;
+    }
+
+    std::size_t round_up(std::size_t bytes, std::size_t page)
+    {
+        return (bytes + page - 1) / page * page;
+    }
+
+    // online_nodes reads the online node list of sysfs, like "0-1" or "0,2-3", into mask. Returns false if it cannot.
+    bool online_nodes(unsigned long *mask)
+    {
+        std::ifstream in("/sys/devices/system/node/online");
+        std::string list;
+        if (!(in >> list))
+        {
+            return false;
+        }
+        bool any = false;
+        std::size_t pos = 0;
+        while (pos < list.size())
+        {
+            std::size_t end = list.find(',', pos);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            std::string range = list.substr(pos, end - pos);
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int node = first; node <= last && node < MAX_NODES; ++node)
+            {
+                mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+                any = true;
+            }
+            pos = end + 1;
+        }
+        return any;
+    }
+
+    // map_file maps length bytes of a new file in directory, which is unlinked right away so that it disappears with the
+    // mapping. The file is sparse, blocks are only allocated when pages are written back.
+    void *map_file(const std::string &directory, std::size_t length)
+    {
+        std::string path = directory + "/dyn_state_XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            throw std::bad_alloc();
+        }
+        unlink(path.c_str());
+        if (ftruncate(fd, length) != 0)
+        {
+            close(fd);
+            throw std::bad_alloc();
+        }
+        void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        // the mapping keeps the file open
+        close(fd);
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        ++created_files;
+        return p;
+    }
+
+    void apply_numa(void *p, std::size_t length, const my::MemoryPolicy &policy)
+    {
+        if (policy.numa == my::NumaPolicy::Default)
+        {
+            return;
+        }
+        unsigned long mask[MASK_WORDS] = {};
+        int mode = MPOL_BIND;
+        if (policy.numa == my::NumaPolicy::Interleave)
+        {
+            mode = MPOL_INTERLEAVE;
+            if (!online_nodes(mask))
+            {
+                ++numa_failures;
+                return;
+            }
+        }
+        else
+        {
+            if (policy.node < 0 || policy.node >= MAX_NODES)
+            {
+                ++numa_failures;
+                return;
+            }
+            mask[policy.node / (8 * sizeof(unsigned long))] |= 1UL << (policy.node % (8 * sizeof(unsigned long)));
+        }
+        // the kernel reads maxnode - 1 bits of the mask
+        if (syscall(SYS_mbind, p, length, mode, mask, MAX_NODES + 1, 0) != 0)
+        {
+            ++numa_failures;
+        }
+    }
+}
+
+bool my::uses_region(const MemoryPolicy &policy, std::size_t bytes)
+{
+    return bytes >= MIN_REGION_SIZE &&
+           (policy.pages != PagePolicy::Default || policy.numa != NumaPolicy::Default || !policy.directory.empty());
+}
+
+void *my::allocate_region(const MemoryPolicy &policy, std::size_t bytes)
+{
+    std::size_t length = round_up(bytes, page_size(policy));
+    void *p = MAP_FAILED;
+    if (!policy.directory.empty())
+    {
+        p = map_file(policy.directory, length);
+        madvise(p, length, MADV_SEQUENTIAL);
+    }
+    else if (policy.pages == PagePolicy::Explicit)
+    {
+        p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            ++huge_tlb_regions;
+        }
+        else
+        {
+            ++explicit_fallbacks;
+        }
+    }
+    if (p == MAP_FAILED && policy.pages != PagePolicy::Default && policy.directory.empty())
+    {
+        // map one huge page more and trim both ends, so the region starts on a huge page boundary and can be collapsed
+        std::size_t padded = length + HUGE_PAGE_SIZE;
+        void *q = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (q == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(q);
+        std::uintptr_t aligned = round_up(start, HUGE_PAGE_SIZE);
+        if (aligned > start)
+        {
+            munmap(q, aligned - start);
+        }
+        if (start + padded > aligned + length)
+        {
+            munmap(reinterpret_cast<void *>(aligned + length), start + padded - (aligned + length));
+        }
+        p = reinterpret_cast<void *>(aligned);
+        madvise(p, length, MADV_HUGEPAGE);
+    }
+    if (p == MAP_FAILED)
+    {
+        p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+    }
+    // nothing is touched yet, every page is placed by the policy when it is first written
+    apply_numa(p, length, policy);
+    ++mapped_regions;
+    mapped_bytes += length;
+    return p;
+}
+
+void my::free_region(void *p, const MemoryPolicy &policy, std::size_t bytes)
+{
+    std::size_t length = round_up(bytes, page_size(policy));
+    munmap(p, length);
+    --mapped_regions;
+    mapped_bytes -= length;
+}
+
+void my::advise_region(const void *p, std::size_t bytes, Access access)
+{
+    if (bytes == 0)
+    {
+        return;
+    }
+    std::size_t page = sysconf(_SC_PAGESIZE);
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(p) / page * page;
+    std::uintptr_t end = round_up(reinterpret_cast<std::uintptr_t>(p) + bytes, page);
+    int advice = MADV_WILLNEED;
+    if (access == Access::Sequential)
+    {
+        advice = MADV_SEQUENTIAL;
+    }
+    else if (access == Access::Random)
+    {
+        advice = MADV_RANDOM;
+    }
+    madvise(reinterpret_cast<void *>(start), end - start, advice);
+}
+
+std::size_t my::state_allocation_bytes(const MemoryPolicy &policy, std::size_t bytes)
+{
+    if (uses_region(policy, bytes))
+    {
+        return round_up(bytes, page_size(policy));
+    }
+    return allocation_bytes(bytes);
+}
+
+my::RegionStats my::region_stats()
+{
+    RegionStats stats;
+    stats.regions = mapped_regions;
+    stats.bytes = mapped_bytes;
+    stats.huge_tlb = huge_tlb_regions;
+    stats.explicit_fallbacks = explicit_fallbacks;
+    stats.numa_failures = numa_failures;
+    stats.files = created_files;
+    return stats;
+}
+
+int my::numa_nodes()
+{
+    unsigned long mask[MASK_WORDS] = {};
+    if (!online_nodes(mask))
+    {
+        return 1;
+    }
+    int count = 0;
+    for (std::size_t i = 0; i < MASK_WORDS; ++i)
+    {
+        count += __builtin_popcountl(mask[i]);
+    }
+    return count;
+}
+
+my::RegionArena::RegionArena(const MemoryPolicy &policy) : _policy(policy), _next(nullptr), _end(nullptr), _free(), _id(0)
+{
+    std::lock_guard<std::mutex> lock(arenas_mutex);
+    for (std::uint32_t id = 1; id < MAX_ARENAS; ++id)
+    {
+        if (arenas[id].load(std::memory_order_relaxed) == nullptr)
+        {
+            arenas[id].store(this, std::memory_order_release);
+            _id = id;
+            break;
+        }
+    }
+}
+
+my::RegionArena::~RegionArena()
+{
+    if (_id != 0)
+    {
+        std::lock_guard<std::mutex> lock(arenas_mutex);
+        arenas[_id].store(nullptr, std::memory_order_release);
+    }
+    for (auto it = _chunks.begin(); it != _chunks.end(); ++it)
+    {
+        free_region(*it, _policy, CHUNK_SIZE);
+    }
+}
+
+void *my::RegionArena::allocate(std::size_t bytes)
+{
+    int size_class = MIN_CLASS;
+    while ((std::size_t(1) << size_class) < bytes)
+    {
+        ++size_class;
+    }
+    if (size_class >= MIN_CLASS + CLASSES)
+    {
+        return allocate_region(_policy, bytes);
+    }
+    std::size_t block = std::size_t(1) << size_class;
+    void *&head = _free[size_class - MIN_CLASS];
+    if (head != nullptr)
+    {
+        void *p = head;
+        head = *static_cast<void **>(p);
+        return p;
+    }
+    if (static_cast<std::size_t>(_end - _next) < block)
+    {
+        // the rest of the current chunk is left unused
+        void *chunk = allocate_region(_policy, CHUNK_SIZE);
+        if (!_policy.directory.empty())
+        {
+            // the blocks of a chunk belong to sets of unrelated vertices, read ahead would only pull in other ones
+            advise_region(chunk, CHUNK_SIZE, Access::Random);
+        }
+        _chunks.push_back(chunk);
+        _next = static_cast<char *>(chunk);
+        _end = _next + CHUNK_SIZE;
+    }
+    // every block is a multiple of 16 bytes, so all of them are aligned like heap blocks
+    void *p = _next;
+    _next += block;
+    return p;
+}
+
+void my::RegionArena::deallocate(void *p, std::size_t bytes)
+{
+    int size_class = MIN_CLASS;
+    while ((std::size_t(1) << size_class) < bytes)
+    {
+        ++size_class;
+    }
+    if (size_class >= MIN_CLASS + CLASSES)
+    {
+        free_region(p, _policy, bytes);
+        return;
+    }
+    void *&head = _free[size_class - MIN_CLASS];
+    *static_cast<void **>(p) = head;
+    head = p;
+}
+
+std::size_t my::RegionArena::chunks()
+{
+    return _chunks.size();
+}
+
+std::size_t my::RegionArena::chunk_bytes()
+{
+    return _chunks.size() * CHUNK_SIZE;
+}
+
+std::uint32_t my::RegionArena::id()
+{
+    return _id;
+}
+
+my::RegionArena *my::region_arena(std::uint32_t id)
+{
+    return (id != 0) ? arenas[id].load(std::memory_order_acquire) : nullptr;
+}
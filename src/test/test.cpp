@@ -1,18 +1,37 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <chrono>
 #include <ctime>
 #include "graph.hpp"
 #include <cassert>
+#include <filesystem>
 #include <fstream>
+#include <set>
+#include <functional>
+#include <sstream>
 #include <vector>
 #include "algo.hpp"
 #include "dyn_graph.hpp"
+#include "async_dyn_graph.hpp"
+#include "offline_dyn_graph.hpp"
+#include "trace.hpp"
+#include "shared_components.hpp"
+#include <future>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/graph/random.hpp>
 #include <boost/graph/kruskal_min_spanning_tree.hpp>
 #include <boost/graph/make_connected.hpp>
 #include "edge_set.hpp"
 #include "gen.hpp"
+#include "adversarial.hpp"
+#include "reordered_dyn_graph.hpp"
+#include "dyn_graph_fork.hpp"
 #include "util.hpp"
 #define MAX_RANDOM_VERTICES 3500
 #define MAX_RANDOM_EDGES 8000
@@ -191,6 +210,1373 @@ void test_fully_connected(mt19937 &mt)
     std::cout << "Success" << std::endl;
 }
 
+void test_reorg_variant(mt19937 &mt, const my::StepScheduler &scheduler, ReorgEngine engine, const std::string &name)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    DynGraph DG(G);
+    DG.set_scheduler(scheduler);
+    DG.set_engine(engine);
+    std::cout << "Testing " << name << " with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        assert(DG.query_is_connected(src, trgt) == my::dfs_scan(G, src, trgt) && "Reorganization variant changed the query result.");
+    }
+    std::cout << "Success" << std::endl;
+}
+
+void test_root_strategies(mt19937 &mt)
+{
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    std::cout << "Testing root strategies on line with " << num_of_vertices << " vertices... " << std::flush;
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_line(G, num_of_vertices, edge_handles);
+        DynGraph center(G, RootStrategy::Center);
+        // the middle of a line is its center, either of the two for an even number of vertices
+        assert((center.get_root() == (num_of_vertices - 1) / 2 || center.get_root() == num_of_vertices / 2) &&
+               "Center of a line should be its middle vertex.");
+    }
+
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    DynGraph DG(G, RootStrategy::HighestDegree);
+    assert(out_degree(DG.get_root(), G) == out_degree(my::highest_degree_vertex(G), G));
+    // re-root aggressively to exercise rebuilding in the middle of a deletion sequence
+    DG.set_reroot_policy(1.01, 4, RootStrategy::Center);
+
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        assert(DG.query_is_connected(src, trgt) == my::dfs_scan(G, src, trgt) && "Re-rooting changed the query result.");
+    }
+    std::cout << "Success" << std::endl;
+}
+
+void test_background_rebuild(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    DynGraph DG(G);
+    std::cout << "Testing background rebuild with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    int deletions = 0;
+    while (num_edges(G) > 0)
+    {
+        // keep a rebuild running for most of the sequence, some swapped in automatically and some forced
+        if (!DG.rebuild_in_progress())
+        {
+            DG.start_background_rebuild(RootStrategy::Center);
+        }
+        else if (deletions % 64 == 0)
+        {
+            DG.finish_background_rebuild(true);
+        }
+
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        ++deletions;
+        assert(DG.query_is_connected(src, trgt) == my::dfs_scan(G, src, trgt) && "Background rebuild changed the query result.");
+    }
+    DG.finish_background_rebuild(true);
+    std::cout << "Success" << std::endl;
+}
+
+// with compaction set, the engine thread also compacts the edge sets whenever its queue runs empty
+void test_async(mt19937 &mt, bool compaction)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    DynGraph DG(G);
+    if (compaction)
+    {
+        DG.set_compaction_policy(0.25, 0);
+    }
+    std::cout << "Testing async submission" << (compaction ? " with idle compaction" : "") << " with " << num_vertices(G)
+              << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    // delete roughly half of the edges from several threads, each thread owning a slice
+    std::vector<std::pair<Vertex, Vertex>> deleted;
+    for (auto it = edge_handles.begin(); it != edge_handles.end(); ++it)
+    {
+        if (mt() % 2 == 0)
+        {
+            deleted.push_back(std::make_pair(source(*it, G), target(*it, G)));
+        }
+    }
+
+    const int threads = 4;
+    {
+        AsyncDynGraph ADG(G, DG, 16);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.push_back(std::thread(
+                [&ADG, &deleted, t]()
+                {
+                    std::vector<std::future<void>> deletes;
+                    std::vector<std::future<bool>> queries;
+                    for (std::size_t i = t; i < deleted.size(); i += threads)
+                    {
+                        deletes.push_back(ADG.submit_delete(deleted[i].first, deleted[i].second));
+                        queries.push_back(ADG.submit_query(deleted[i].first, deleted[i].second));
+                    }
+                    for (auto it = deletes.begin(); it != deletes.end(); ++it)
+                    {
+                        it->get();
+                    }
+                    for (auto it = queries.begin(); it != queries.end(); ++it)
+                    {
+                        it->get();
+                    }
+                }));
+        }
+        for (auto it = workers.begin(); it != workers.end(); ++it)
+        {
+            it->join();
+        }
+
+        // every deletion has been applied, so both the fast path and the queue must agree with a scan
+        for (auto it = deleted.begin(); it != deleted.end(); ++it)
+        {
+            bool expected = my::dfs_scan(G, it->first, it->second);
+            bool answer = ADG.submit_query(it->first, it->second).get();
+            assert(answer == expected && "Async query disagrees with DFS.");
+        }
+    }
+    assert(num_edges(G) == edge_handles.size() - deleted.size());
+    std::cout << "Success" << std::endl;
+}
+
+void test_counters(mt19937 &mt, ReorgEngine engine)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    DynGraph DG(G);
+    DG.set_engine(engine);
+    std::cout << "Testing work counters with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    my::ReorgCounters sum;
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        bool connected = my::dfs_scan(G, src, trgt);
+        assert(DG.query_is_connected(src, trgt) == connected);
+
+        const my::ReorgCounters &last = DG.last_counters();
+        sum += last;
+#ifdef DYN_COUNTERS
+        assert(last.deletions == 1);
+        assert((last.small_component_size > 0) == !connected && "Counted component size does not match the query.");
+        assert(last.records_rewound <= last.records_pushed);
+        // process B always takes its first step, process A only stops early when B finishes
+        assert(last.total_b_steps() > 0);
+        if (!connected)
+        {
+            assert(last.total_a_steps() >= last.small_component_size && "Process A must visit the whole small component.");
+        }
+#else
+        assert(last.deletions == 0 && last.total_a_steps() == 0 && last.total_b_steps() == 0);
+#endif
+    }
+
+    const my::ReorgCounters &total = DG.total_counters();
+    assert(total.deletions == sum.deletions && total.level_bumps == sum.level_bumps && total.edges_moved == sum.edges_moved);
+    assert(total.total_a_steps() == sum.total_a_steps() && total.total_b_steps() == sum.total_b_steps());
+    DG.reset_counters();
+    assert(DG.total_counters().deletions == 0);
+    std::cout << "Success" << std::endl;
+}
+
+void test_latency_histogram(mt19937 &mt)
+{
+    std::cout << "Testing latency histogram... " << std::flush;
+    my::LatencyHistogram h, other;
+    std::vector<std::uint64_t> values;
+    for (int i = 0; i < 10000; ++i)
+    {
+        // spread over many orders of magnitude
+        std::uint64_t v = mt() >> (mt() % 32);
+        values.push_back(v);
+        (i % 2 == 0 ? h : other).record(v);
+    }
+    h += other;
+    assert(h.count() == values.size());
+    std::sort(values.begin(), values.end());
+    assert(h.min() == values.front() && h.max() == values.back());
+    const double ps[] = {1, 50, 90, 99, 99.9, 100};
+    for (double p : ps)
+    {
+        std::uint64_t exact = values[std::max<std::size_t>(std::ceil(p / 100 * values.size()), 1) - 1];
+        std::uint64_t approx = h.percentile(p);
+        // the bucket holding the value ends at most 1 / SUB_BUCKETS above it
+        assert(approx >= exact && approx - exact <= exact / my::LatencyHistogram::SUB_BUCKETS && "Percentile outside of its bucket.");
+    }
+    h.reset();
+    assert(h.count() == 0 && h.percentile(99) == 0);
+
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_random(G, 500, 1000, edge_handles, mt);
+    DynGraph DG(G);
+    std::size_t deletions = 0;
+    while (num_edges(G) > 0)
+    {
+        DG.dyn_remove_edge(random_edge(G, mt));
+        ++deletions;
+        DG.query_is_connected(0, 1);
+    }
+    assert(DG.reorg_latency().count() == deletions && DG.query_latency().count() == deletions);
+    assert(DG.reorg_latency().max() >= DG.last_reorg_ticks());
+    DG.reset_latency();
+    DG.set_latency_tracking(false);
+    DG.query_is_connected(0, 1);
+    assert(DG.reorg_latency().count() == 0 && DG.query_latency().count() == 0);
+    std::cout << "Success" << std::endl;
+}
+
+void test_offline(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing offline mode with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    // delete every edge in random order
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+
+    OfflineDynGraph ODG(G, deletions);
+    std::vector<std::vector<int>> components;
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        Vertex src = deletions[q].first;
+        Vertex trgt = deletions[q].second;
+        ODG.dyn_remove_edge(edge(src, trgt, G).first);
+        bool connected = my::dfs_scan(G, src, trgt);
+        assert(ODG.query_is_connected(src, trgt) == connected && "Offline mode returned wrong result.");
+        assert(ODG.deletion_breaks(q) == !connected);
+
+        // a random pair, checked against its answer at an earlier step after all deletions
+        Vertex a = mt() % num_vertices(G);
+        Vertex b = mt() % num_vertices(G);
+        assert(ODG.query_is_connected_at(q / 2, a, b) == ODG.query_is_connected_at(q / 2, b, a));
+        if (!ODG.query_is_connected_at(q / 2, a, b))
+        {
+            // deletions never connect vertices
+            assert(!ODG.query_is_connected(a, b));
+        }
+    }
+    assert(ODG.current_step() == ODG.num_steps());
+    std::cout << "Success" << std::endl;
+}
+
+void test_trace(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing workload trace with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    std::string path = "test_trace.eswl";
+    DynGraph DG(G);
+    DG.set_engine(ReorgEngine::Coroutine);
+    DG.set_reroot_policy(1.5, 4, RootStrategy::HighestDegree, true);
+    assert(!DG.start_trace(path) && "A trace with background rebuilds cannot be replayed.");
+    DG.set_reroot_policy(1.5, 4, RootStrategy::Random);
+    assert(!DG.start_trace(path) && "A trace with random roots cannot be replayed.");
+
+    // the settings the trace has to carry, with scheduler averages away from their defaults
+    my::StepScheduler adaptive(4, 2, 1, my::SchedulePolicy::Adaptive, 4);
+    adaptive.restore_averages(0.8, 12.0);
+    DG.set_scheduler(adaptive);
+    DG.set_reroot_policy(1.1, 4, RootStrategy::HighestDegree);
+    DG.set_compaction_policy(0.5, 3);
+    my::TraceSettings settings = DG.trace_settings();
+    bool opened = DG.start_trace(path);
+    assert(opened && "Could not write the trace.");
+    // the reroot policy may move the root while the trace runs
+    Vertex root = DG.get_root();
+    std::uint64_t fingerprint = my::graph_fingerprint(G);
+    std::vector<bool> answers;
+    // delete about half of the edges
+    std::size_t deletions = num_edges(G) / 2;
+    for (std::size_t q = 0; q < deletions; ++q)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        answers.push_back(DG.query_is_connected(src, trgt));
+    }
+    DG.stop_trace();
+
+    my::WorkloadTrace trace;
+    std::string error;
+    bool read = my::read_trace(path, trace, error);
+    assert(read && "Could not read the trace back.");
+    assert(trace.fingerprint == fingerprint && trace.root == root && trace.deletions.size() == deletions);
+    assert(static_cast<ReorgEngine>(trace.engine) == ReorgEngine::Coroutine);
+    const my::StepScheduler &scheduler = trace.settings.scheduler;
+    assert(scheduler.quantum() == 4 && scheduler.policy() == my::SchedulePolicy::Adaptive && scheduler.max_ratio() == 4);
+    assert(scheduler.ratio_a() == 2 && scheduler.ratio_b() == 1);
+    assert(scheduler.a_win_rate() == 0.8 && scheduler.avg_small_size() == 12.0);
+    assert(trace.settings.reroot_drift_factor == 1.1 && trace.settings.reroot_min_deletions == 4);
+    assert(trace.settings.reroot_strategy == static_cast<std::uint64_t>(RootStrategy::HighestDegree));
+    assert(trace.settings.compact_min_load_factor == 0.5 && trace.settings.compact_per_deletion == 3);
+    assert(trace.settings.compact_cursor == settings.compact_cursor);
+
+    // the replay has to end in the same structure, not only give the same answers
+    Graph G_replay;
+    my::build_graph(trace, G_replay);
+    assert(my::graph_fingerprint(G_replay) == fingerprint);
+    DynGraph replay(G_replay, trace.root);
+    replay.set_engine(static_cast<ReorgEngine>(trace.engine));
+    replay.apply_trace_settings(trace.settings);
+    for (std::size_t q = 0; q < trace.deletions.size(); ++q)
+    {
+        const my::TraceDeletion &d = trace.deletions[q];
+        assert(d.breaks == !answers[q]);
+        // the recorded order of the endpoints decides which side Process A relabels
+        remove_edge(edge(d.v, d.u, G_replay).first, G_replay);
+        replay.reorg_after_remove(d.v, d.u);
+        assert(replay.query_is_connected(d.v, d.u) == answers[q]);
+    }
+    assert(replay._levels == DG._levels && replay._components == DG._components && "Replay diverged from the recorded run.");
+    assert(replay.get_root() == DG.get_root());
+
+    // an engine this build does not know is rejected, not cast. The engine follows the magic and the one byte version.
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(5);
+        file.put(static_cast<char>(0x7f));
+    }
+    bool read_bad = my::read_trace(path, trace, error);
+    assert(!read_bad && error == "unknown engine");
+    std::remove(path.c_str());
+    std::cout << "Success" << std::endl;
+}
+
+// count_occurrences counts the non-overlapping occurrences of needle in text
+std::size_t count_occurrences(const std::string &text, const std::string &needle)
+{
+    std::size_t count = 0;
+    for (std::size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + needle.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+
+void test_phase_trace(mt19937 &mt, ReorgEngine engine)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing phase trace (" << (engine == ReorgEngine::Coroutine ? "coroutine" : "state machine") << ") with "
+              << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    std::string path = "test_phase_trace.json";
+    DynGraph DG(G);
+    DG.set_engine(engine);
+    assert(!DG.stop_phase_trace() && "No phase trace is running yet.");
+    bool opened = DG.start_phase_trace(path);
+    assert(opened && "Could not write the phase trace.");
+    DG.init(RootStrategy::Fixed);
+    std::size_t deletions = num_edges(G) / 2;
+    std::size_t breaks = 0;
+    for (std::size_t q = 0; q < deletions; ++q)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        breaks += DG.query_is_connected(src, trgt) ? 0 : 1;
+    }
+    bool written = DG.stop_phase_trace();
+    assert(written && "Could not write the phase trace.");
+
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string json = buffer.str();
+    assert(json.rfind("{\"displayTimeUnit\"", 0) == 0 && json.size() >= 4 && json.substr(json.size() - 4) == "\n]}\n");
+    assert(count_occurrences(json, "\"name\":\"init\"") == 1);
+    assert(count_occurrences(json, "\"name\":\"reorg\"") == deletions);
+    // every breaking deletion rewinds process B
+    assert(count_occurrences(json, "\"name\":\"rewind\"") == breaks);
+    assert(count_occurrences(json, "\"breaks\":1") == breaks);
+    assert(deletions == 0 || count_occurrences(json, "\"name\":\"A\"") > 0);
+
+    // past max_events the events are dropped, the file stays valid
+    bool reopened = DG.start_phase_trace(path, 3);
+    assert(reopened);
+    for (std::size_t q = 0; q < 5 && num_edges(G) > 0; ++q)
+    {
+        DG.dyn_remove_edge(random_edge(G, mt));
+    }
+    DG.stop_phase_trace();
+    std::ifstream capped(path);
+    std::stringstream capped_buffer;
+    capped_buffer << capped.rdbuf();
+    json = capped_buffer.str();
+    assert(count_occurrences(json, "\"ph\":\"X\"") <= 3 && json.substr(json.size() - 4) == "\n]}\n");
+    std::remove(path.c_str());
+    std::cout << "Success" << std::endl;
+}
+
+// check_edge_set asserts that set holds exactly the edges of expected, through contains and through iteration
+void check_edge_set(EdgeSet &set, const std::set<std::pair<Vertex, Vertex>> &expected)
+{
+    assert(set.size() == expected.size() && set.empty() == expected.empty());
+    std::set<std::pair<Vertex, Vertex>> seen;
+    for (auto it = set.begin(); it != set.end(); ++it)
+    {
+        bool first_visit = seen.insert(*it).second;
+        assert(expected.count(*it) == 1 && first_visit && "Iteration has to visit every edge once.");
+    }
+    assert(seen.size() == expected.size());
+    for (auto it = expected.begin(); it != expected.end(); ++it)
+    {
+        assert(set.contains(it->second, it->first));
+    }
+    assert(set.is_hashed() || set.memory_usage() == 0);
+}
+
+void test_edge_set(mt19937 &mt)
+{
+    std::cout << "Testing adaptive edge sets... " << std::flush;
+    // the edges of a vertex 0 with up to 12 neighbours, so the set crosses both thresholds many times
+    const Vertex degree = 12;
+    EdgeSet set;
+    std::set<std::pair<Vertex, Vertex>> expected;
+    bool was_hashed = false;
+    bool was_shrunk = false;
+    for (int i = 0; i < 5000; ++i)
+    {
+        Vertex w = 1 + mt() % degree;
+        if (mt() % 2 == 0)
+        {
+            set.add_edge(w, 0);
+            expected.insert(std::make_pair(0, w));
+        }
+        else
+        {
+            bool removed = set.remove_edge(0, w);
+            bool erased = expected.erase(std::make_pair(0, w)) == 1;
+            assert(removed == erased);
+        }
+        assert(set.is_hashed() || set.size() <= EdgeSet::INLINE_CAPACITY);
+        assert(!set.is_hashed() || set.size() > EdgeSet::SHRINK_SIZE);
+        was_shrunk = was_shrunk || (was_hashed && !set.is_hashed());
+        was_hashed = set.is_hashed();
+        check_edge_set(set, expected);
+
+        // moving in either representation leaves the source empty, as Process B and _rewind expect
+        if (i % 100 == 0)
+        {
+            EdgeSet moved(std::move(set));
+            assert(set.empty() && set.begin() == set.end());
+            check_edge_set(moved, expected);
+            set = std::move(moved);
+            assert(moved.empty() && !moved.is_hashed());
+            check_edge_set(set, expected);
+        }
+    }
+    assert(was_shrunk && "The set never went back to inline storage.");
+
+    set.clear();
+    assert(set.empty() && !set.is_hashed() && set.memory_usage() == 0);
+    std::cout << "Success" << std::endl;
+}
+
+// edge_set_bytes sums the hash table memory of alpha, beta and gamma
+std::size_t edge_set_bytes(DynGraph &DG)
+{
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < DG._levels.size(); ++i)
+    {
+        bytes += DG.alpha[i].memory_usage() + DG.beta[i].memory_usage() + DG.gamma[i].memory_usage();
+    }
+    return bytes;
+}
+
+void test_compaction(mt19937 &mt)
+{
+    // a complete graph, every vertex starts with large sets
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % 200 + 50;
+    gen::generate_fully_connected(G, num_of_vertices, edge_handles);
+    std::cout << "Testing edge set compaction with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+    DynGraph DG(G, 0);
+    assert(!DG.compaction_pending() && "The compaction is disabled by default.");
+
+    // drain most of the edges without compaction, the tables keep their peak buckets
+    std::size_t drained = num_edges(G) * 9 / 10;
+    for (std::size_t i = 0; i < drained; ++i)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex u = source(e, G);
+        Vertex v = target(e, G);
+        DG.dyn_remove_edge(e);
+        assert(DG.query_is_connected(u, v) == my::dfs_scan(G, u, v));
+    }
+    assert(DG.compaction_stats().sweeps == 0);
+
+    // one full pass by hand, what it reports is what memory_usage loses
+    DG.set_compaction_policy(0.25, 0);
+    assert(DG.compaction_pending());
+    std::size_t before = edge_set_bytes(DG);
+    std::size_t released = DG.compact_edge_sets(num_vertices(G));
+    assert(released > 0 && edge_set_bytes(DG) == before - released);
+    assert(DG.compaction_stats().sweeps == 1 && DG.compaction_stats().bytes_released == released);
+    assert(!DG.compaction_pending() && "No deletion happened during the pass.");
+    for (std::size_t i = 0; i < num_vertices(G); ++i)
+    {
+        EdgeSet *sets[3] = {&DG.alpha[i], &DG.beta[i], &DG.gamma[i]};
+        for (int s = 0; s < 3; ++s)
+        {
+            assert((sets[s]->is_hashed() || sets[s]->size() <= EdgeSet::INLINE_CAPACITY) &&
+                   (!sets[s]->is_hashed() || sets[s]->size() > EdgeSet::INLINE_CAPACITY));
+        }
+    }
+
+    // the rest with a slice after every deletion, the answers do not change and the deletions never trim the heap
+    DG.set_compaction_policy(0.25, 8, 0);
+    std::size_t trims = DG.compaction_stats().trims;
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex u = source(e, G);
+        Vertex v = target(e, G);
+        DG.dyn_remove_edge(e);
+        assert(DG.query_is_connected(u, v) == my::dfs_scan(G, u, v));
+    }
+    assert(DG.compaction_stats().trims == trims);
+    DG.compact_edge_sets(num_vertices(G));
+    assert(edge_set_bytes(DG) == 0 && "Empty sets have to be inline.");
+    assert(DG.compaction_stats().trims > trims);
+    std::cout << "Success" << std::endl;
+}
+
+void test_memory_usage(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing memory usage with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    EdgeSet empty;
+    assert(empty.memory_usage() == 0);
+
+    DynGraph DG(G);
+    my::MemoryUsage before = DG.memory_usage();
+    assert(before.levels >= num_vertices(G) * sizeof(int) && before.components >= num_vertices(G) * sizeof(int));
+    // every edge is in alpha and gamma, or twice in beta
+    assert(before.alpha + before.beta + before.gamma > 2 * num_edges(G) * sizeof(std::pair<Vertex, Vertex>));
+    assert(before.change_log_peak == 0);
+    assert(before.total() == before.graph + before.levels + before.components + before.alpha + before.beta + before.gamma);
+
+    std::size_t peak = 0;
+    std::size_t graph = before.graph;
+    while (num_edges(G) > 0)
+    {
+        DG.dyn_remove_edge(random_edge(G, mt));
+        my::MemoryUsage usage = DG.memory_usage();
+        assert(usage.change_log_peak >= peak && "The change log peak cannot decrease.");
+        assert(usage.graph < graph && "Removing an edge has to free graph memory.");
+        peak = usage.change_log_peak;
+        graph = usage.graph;
+    }
+    std::cout << "Success" << std::endl;
+}
+
+void test_memory_policy(mt19937 &mt)
+{
+    // large enough for every per-vertex array to be mapped as a region
+    const std::size_t n = 20000;
+    const std::size_t deletions = 300;
+    Graph G;
+    std::vector<Edge> edge_handles;
+    gen::generate_random(G, n, 3 * n, edge_handles, mt);
+    std::cout << "Testing memory policies with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    my::MemoryPolicy heap;
+    assert(!my::uses_region(heap, n * sizeof(int)));
+    assert(my::numa_nodes() >= 1);
+
+    const my::PagePolicy pages[3] = {my::PagePolicy::Default, my::PagePolicy::Transparent, my::PagePolicy::Explicit};
+    const my::NumaPolicy numa[3] = {my::NumaPolicy::Default, my::NumaPolicy::Interleave, my::NumaPolicy::Bind};
+    std::vector<my::MemoryPolicy> policies;
+    for (int p = 0; p < 3; ++p)
+    {
+        for (int q = 0; q < 3; ++q)
+        {
+            my::MemoryPolicy policy;
+            policy.pages = pages[p];
+            policy.numa = numa[q];
+            policies.push_back(policy);
+        }
+    }
+    // out-of-core, with a page policy that has to be ignored
+    my::MemoryPolicy file_backed;
+    file_backed.pages = my::PagePolicy::Transparent;
+    file_backed.directory = std::filesystem::temp_directory_path().string();
+    policies.push_back(file_backed);
+
+    for (auto it = policies.begin(); it != policies.end(); ++it)
+    {
+        const my::MemoryPolicy &policy = *it;
+        assert(!my::uses_region(policy, my::MIN_REGION_SIZE - 1));
+        my::RegionStats before = my::region_stats();
+        {
+            // the same deletions on a copy under the default policy give the reference answers
+            Graph H(G);
+            Graph R(G);
+            DynGraph DG(H, 0, policy);
+            DynGraph ref(R, 0);
+            assert(DG.memory_policy() == policy);
+            my::RegionStats during = my::region_stats();
+            if (my::uses_region(policy, n * sizeof(int)))
+            {
+                // levels, components, alpha, beta and gamma, and the chunks the hash tables of the sets are carved from
+                assert(during.regions > before.regions + 5);
+                assert(DG.memory_usage().levels % 4096 == 0);
+            }
+            else
+            {
+                assert(during.regions == before.regions);
+            }
+            if (!policy.directory.empty())
+            {
+                assert(during.files - before.files == during.regions - before.regions);
+            }
+            else if (policy.pages != my::PagePolicy::Default)
+            {
+                assert(reinterpret_cast<std::uintptr_t>(DG._levels.data()) % my::HUGE_PAGE_SIZE == 0);
+            }
+            for (std::size_t i = 0; i < deletions && num_edges(H) > 0; ++i)
+            {
+                Edge e = random_edge(H, mt);
+                Vertex u = source(e, H);
+                Vertex v = target(e, H);
+                bool removed = DG.dyn_remove_edge(u, v);
+                bool removed_ref = ref.dyn_remove_edge(u, v);
+                assert(removed && removed == removed_ref);
+                assert(DG.query_is_connected(u, v) == ref.query_is_connected(u, v));
+            }
+            assert(std::equal(DG._levels.begin(), DG._levels.end(), ref._levels.begin(), ref._levels.end()));
+        }
+        assert(my::region_stats().regions == before.regions && my::region_stats().bytes == before.bytes);
+    }
+    std::cout << "Success" << std::endl;
+}
+
+void test_shared_components(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing shared memory replicas with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    DynGraph DG(G);
+    std::string error;
+    bool published = DG.start_publishing("/no/such/segment", true, error);
+    assert(!published && !error.empty());
+    std::string name = "/dyn_connected_test_" + std::to_string(getpid());
+    published = DG.start_publishing(name, true, error);
+    assert(published && "Cannot create the shared memory segment.");
+
+    my::SharedComponentsReader reader;
+    bool opened = reader.open(name, error);
+    assert(opened);
+    assert(reader.num_vertices() == num_vertices(G) && reader.has_levels() && reader.deletions() == 0);
+
+    // the replica follows every deletion, the components and the level increases that were kept
+    std::uint64_t deletions = 0;
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex u = source(e, G);
+        Vertex v = target(e, G);
+        DG.dyn_remove_edge(e);
+        ++deletions;
+        assert(reader.deletions() == deletions);
+        bool connected = false;
+        bool answered = reader.query_is_connected(u, v, connected);
+        assert(answered && connected == DG.query_is_connected(u, v));
+        Vertex w = mt() % num_vertices(G);
+        assert(reader.component(w) == DG._components[w] && reader.level(w) == DG._levels[w]);
+        if (deletions % 64 == 0)
+        {
+            for (std::size_t x = 0; x < num_vertices(G); ++x)
+            {
+                assert(reader.component(x) == DG._components[x] && reader.level(x) == DG._levels[x]);
+            }
+        }
+    }
+
+    // a process of its own sees the same state
+    pid_t child = fork();
+    if (child == 0)
+    {
+        my::SharedComponentsReader other;
+        bool same = other.open(name, error) && other.deletions() == deletions;
+        for (std::size_t x = 0; same && x < num_vertices(G); ++x)
+        {
+            same = other.component(x) == DG._components[x];
+        }
+        _exit(same ? 0 : 1);
+    }
+    int status = 0;
+    pid_t waited = waitpid(child, &status, 0);
+    assert(child > 0 && waited == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0 && "The replica of another process disagrees.");
+
+    DG.stop_publishing();
+    my::SharedComponentsReader gone;
+    opened = gone.open(name, error);
+    assert(!opened && "stop_publishing has to remove the segment.");
+    // the mapping of an open reader outlives the segment
+    assert(reader.deletions() == deletions);
+
+    // a writer that dies in the middle of an update fails the queries instead of hanging them
+    std::string dead_name = name + "_dead";
+    pid_t writer = fork();
+    if (writer == 0)
+    {
+        my::SharedComponentsWriter dying;
+        if (!dying.create(dead_name, 4, false, error))
+        {
+            _exit(1);
+        }
+        dying.begin();
+        // _exit skips the destructor, the segment stays behind in the middle of the update
+        _exit(0);
+    }
+    waited = waitpid(writer, &status, 0);
+    assert(writer > 0 && waited == writer && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    my::SharedComponentsReader orphan;
+    opened = orphan.open(dead_name, error);
+    assert(opened);
+    bool connected = true;
+    bool answered = orphan.query_is_connected(0, 1, connected);
+    assert(!answered && orphan.component(0) == -1);
+    shm_unlink(dead_name.c_str());
+    std::cout << "Success" << std::endl;
+}
+
+// check_simple asserts that G has no self loops and no parallel edges, and that edge_handles holds every edge
+void check_simple(const Graph &G, const std::vector<Edge> &edge_handles)
+{
+    assert(edge_handles.size() == num_edges(G));
+    EdgeSet seen;
+    for (auto it = edge_handles.begin(); it != edge_handles.end(); ++it)
+    {
+        Vertex u = source(*it, G);
+        Vertex v = target(*it, G);
+        assert(u != v && "Generators must not create self loops.");
+        assert(!seen.contains(u, v) && "Generators must not create parallel edges.");
+        seen.add_edge(u, v);
+    }
+}
+
+// delete_all_checked deletes every edge of G in random order and compares every answer with a DFS
+void delete_all_checked(Graph &G, mt19937 &mt)
+{
+    DynGraph DG(G);
+    while (num_edges(G) > 0)
+    {
+        Edge e = random_edge(G, mt);
+        Vertex src = source(e, G);
+        Vertex trgt = target(e, G);
+        DG.dyn_remove_edge(e);
+        assert(DG.query_is_connected(src, trgt) == my::dfs_scan(G, src, trgt) && "Wrong result on a generated graph.");
+    }
+}
+
+void test_generators(mt19937 &mt)
+{
+    std::cout << "Testing graph generators... " << std::flush;
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_grid_2d(G, 30, 20, edge_handles);
+        assert(num_vertices(G) == 600 && num_edges(G) == 29 * 20 + 30 * 19);
+        check_simple(G, edge_handles);
+        delete_all_checked(G, mt);
+    }
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_grid_3d(G, 8, 7, 6, edge_handles);
+        assert(num_vertices(G) == 336 && num_edges(G) == 7 * 7 * 6 + 8 * 6 * 6 + 8 * 7 * 5);
+        check_simple(G, edge_handles);
+        delete_all_checked(G, mt);
+    }
+    std::uint64_t seed = mt();
+    {
+        // the graph depends on the seed only, not on the number of threads
+        Graph G1, G4;
+        std::vector<Edge> handles1, handles4;
+        gen::generate_rmat(G1, 11, 3000000, handles1, seed, 0.57, 0.19, 0.19, 1);
+        gen::generate_rmat(G4, 11, 3000000, handles4, seed, 0.57, 0.19, 0.19, 4);
+        assert(num_edges(G1) == num_edges(G4));
+        for (std::size_t i = 0; i < handles1.size(); ++i)
+        {
+            assert(source(handles1[i], G1) == source(handles4[i], G4) && target(handles1[i], G1) == target(handles4[i], G4));
+        }
+        check_simple(G1, handles1);
+    }
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_rmat(G, 10, 6000, edge_handles, seed);
+        check_simple(G, edge_handles);
+        delete_all_checked(G, mt);
+    }
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::generate_barabasi_albert(G, 2000, 3, edge_handles, seed);
+        assert(num_vertices(G) == 2000 && num_edges(G) <= 6000);
+        check_simple(G, edge_handles);
+        delete_all_checked(G, mt);
+    }
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        // complete blocks and no edges across: the components are exactly the blocks
+        gen::generate_sbm(G, 100, 4, 1.0, 0.0, edge_handles, seed);
+        assert(num_edges(G) == 4 * (25 * 24 / 2));
+        check_simple(G, edge_handles);
+        assert(my::dfs_scan(G, 0, 24) && !my::dfs_scan(G, 24, 25));
+        Graph S;
+        std::vector<Edge> sparse_handles;
+        gen::generate_sbm(S, 2000, 8, 0.03, 0.001, sparse_handles, seed, 3);
+        check_simple(S, sparse_handles);
+        delete_all_checked(S, mt);
+
+        // a single dense block is split into several tasks, still independent of the number of threads
+        Graph D1, D4;
+        std::vector<Edge> dense1, dense4;
+        gen::generate_sbm(D1, 3000, 1, 0.3, 0.0, dense1, seed, 1);
+        gen::generate_sbm(D4, 3000, 1, 0.3, 0.0, dense4, seed, 4);
+        assert(num_edges(D1) == num_edges(D4) && num_edges(D1) > 0);
+        for (std::size_t i = 0; i < dense1.size(); ++i)
+        {
+            assert(source(dense1[i], D1) == source(dense4[i], D4) && target(dense1[i], D1) == target(dense4[i], D4));
+        }
+    }
+    std::cout << "Success" << std::endl;
+}
+
+// run_workload_checked replays an adversarial workload on both engines, checking every answer with a DFS, and returns the
+// structure built with the state machine engine after the last deletion in levels and components
+void run_workload_checked(const std::function<gen::Workload(Graph &, std::vector<Edge> &)> &build,
+                          my::StateVector<int> &levels, my::StateVector<int> &components)
+{
+    const ReorgEngine engines[2] = {ReorgEngine::StateMachine, ReorgEngine::Coroutine};
+    for (int en = 0; en < 2; ++en)
+    {
+        Graph G;
+        std::vector<Edge> edge_handles;
+        gen::Workload workload = build(G, edge_handles);
+        assert(edge_handles.size() == num_edges(G));
+        DynGraph DG(G, workload.root);
+        DG.set_engine(engines[en]);
+        for (auto it = workload.deletions.begin(); it != workload.deletions.end(); ++it)
+        {
+            Edge e;
+            bool found;
+            tie(e, found) = edge(it->first, it->second, G);
+            assert(found && "Every deletion of a workload has to be an edge at that time.");
+            remove_edge(e, G);
+            DG.reorg_after_remove(it->first, it->second);
+            assert(DG.query_is_connected(it->first, it->second) == my::dfs_scan(G, it->first, it->second));
+        }
+        if (en == 0)
+        {
+            levels = DG._levels;
+            components = DG._components;
+        }
+        else
+        {
+            assert(levels == DG._levels && components == DG._components && "The engines disagree on a workload.");
+        }
+    }
+}
+
+void test_adversarial()
+{
+    std::cout << "Testing adversarial workloads... " << std::flush;
+    const int layers = 10;
+    const int width = 3;
+    my::StateVector<int> levels, components;
+
+    // width 1 is the ring cut next to the root
+    Graph ring;
+    std::vector<Edge> ring_handles;
+    gen::Workload ring_workload = gen::adversarial_level_bumps(ring, layers, 1, ring_handles);
+    assert(num_vertices(ring) == layers + 1 && num_edges(ring) == layers + 1 && ring_workload.deletions.size() == 1);
+
+    // no deletion disconnects, the first layers climb to the far side of the ring
+    run_workload_checked([&](Graph &G, std::vector<Edge> &handles)
+                         { return gen::adversarial_level_bumps(G, layers, width, handles); },
+                         levels, components);
+    for (int l = 1; l <= layers; ++l)
+    {
+        for (int j = 0; j < width; ++j)
+        {
+            assert(levels[1 + (l - 1) * width + j] == layers + 1 - l && components[1 + (l - 1) * width + j] == components[0]);
+        }
+    }
+
+    // the bridge splits the graph into two equal halves
+    run_workload_checked([&](Graph &G, std::vector<Edge> &handles)
+                         { return gen::adversarial_race(G, layers, width, handles); },
+                         levels, components);
+    std::size_t half = 1 + layers * width;
+    assert(std::count(components.begin(), components.end(), components[0]) == static_cast<long>(half));
+    assert(std::count(components.begin(), components.end(), components[half]) == static_cast<long>(half));
+    assert(components[0] != components[half]);
+
+    // every cut disconnects, every clique ends up alone
+    const int segments = 16;
+    run_workload_checked([&](Graph &G, std::vector<Edge> &handles)
+                         { return gen::adversarial_halving(G, segments, width, handles); },
+                         levels, components);
+    std::vector<int> distinct(components.begin(), components.end());
+    std::sort(distinct.begin(), distinct.end());
+    assert(std::unique(distinct.begin(), distinct.end()) - distinct.begin() == segments);
+    std::cout << "Success" << std::endl;
+}
+
+void test_remove_by_endpoints(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing deletion by endpoints with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    // the reference deletes through edge descriptors, the endpoint index has to give the very same structure
+    Graph G_ref(G);
+    Vertex r = vertex(mt() % num_vertices(G), G);
+    DynGraph DG(G, r);
+    DynGraph reference(G_ref, r);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        Vertex u = deletions[q].first;
+        Vertex v = deletions[q].second;
+        // mix the three ways of deleting, the index has to follow all of them
+        switch (q % 3)
+        {
+        case 0:
+        {
+            bool removed = DG.dyn_remove_edge(u, v);
+            assert(removed);
+            break;
+        }
+        case 1:
+            DG.dyn_remove_edge(edge(u, v, G).first);
+            break;
+        default:
+            remove_edge(edge(u, v, G).first, G);
+            DG.reorg_after_remove(v, u);
+            break;
+        }
+        reference.dyn_remove_edge(edge(u, v, G_ref).first);
+        bool removed_again = DG.dyn_remove_edge(u, v);
+        assert(!removed_again && "The edge has already been deleted.");
+        assert(num_edges(G) == num_edges(G_ref));
+        assert(DG.query_is_connected(u, v) == my::dfs_scan(G, u, v));
+    }
+    assert(DG._levels == reference._levels && DG._components == reference._components);
+    assert(DG.memory_usage().edge_index > 0 || deletions.empty());
+
+    // parallel edges, each one removed once whichever way it is deleted
+    Graph P(3);
+    for (int i = 0; i < 3; ++i)
+    {
+        add_edge(0, 1, P);
+    }
+    add_edge(1, 2, P);
+    add_edge(2, 0, P);
+    DynGraph DP(P, 0);
+    DP.build_edge_index();
+    remove_edge(edge(0, 1, P).first, P);
+    DP.reorg_after_remove(1, 0);
+    DP.dyn_remove_edge(edge(1, 0, P).first);
+    bool removed = DP.dyn_remove_edge(1, 0);
+    bool removed_again = DP.dyn_remove_edge(0, 1);
+    assert(removed && !removed_again && num_edges(P) == 2);
+    assert(DP.query_is_connected(0, 1) && !edge(0, 1, P).second);
+    std::cout << "Success" << std::endl;
+}
+
+// same_structure compares the graphs and the ES structures of a and b, down to the order of the out-edges
+bool same_structure(Graph &G, DynGraph &a, Graph &H, DynGraph &b)
+{
+    if (a._levels != b._levels || a._components != b._components || num_edges(G) != num_edges(H))
+    {
+        return false;
+    }
+    for (Vertex w = 0; w < num_vertices(G); ++w)
+    {
+        OutEdgeIterator ei, eiend, fi, fiend;
+        tie(ei, eiend) = out_edges(w, G);
+        tie(fi, fiend) = out_edges(w, H);
+        for (; ei != eiend && fi != fiend; ++ei, ++fi)
+        {
+            if (target(*ei, G) != target(*fi, H))
+            {
+                return false;
+            }
+        }
+        if (ei != eiend || fi != fiend)
+        {
+            return false;
+        }
+        my::StateVector<EdgeSet> *sets_a[] = {&a.alpha, &a.beta, &a.gamma};
+        my::StateVector<EdgeSet> *sets_b[] = {&b.alpha, &b.beta, &b.gamma};
+        for (int i = 0; i < 3; ++i)
+        {
+            EdgeSet &x = (*sets_a[i])[w];
+            EdgeSet &y = (*sets_b[i])[w];
+            if (x.size() != y.size())
+            {
+                return false;
+            }
+            for (auto it = x.begin(); it != x.end(); ++it)
+            {
+                if (!y.contains(it->first, it->second))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void test_would_disconnect(mt19937 &mt, ReorgEngine engine)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing what-if deletions with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    // the reference only sees the real deletions, the speculative ones must leave DG identical to it
+    Graph G_ref(G);
+    Vertex r = vertex(mt() % num_vertices(G), G);
+    DynGraph DG(G, r);
+    DynGraph reference(G_ref, r);
+    DG.set_engine(engine);
+    reference.set_engine(engine);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        Vertex u = deletions[q].first;
+        Vertex v = deletions[q].second;
+        Edge e = edge(u, v, G).first;
+        bool disconnects = DG.would_disconnect(e);
+        assert(same_structure(G, DG, G_ref, reference));
+
+        if (q % 5 == 0)
+        {
+            // a few of the next deletions at once, answered for a random pair
+            std::vector<Edge> batch;
+            Graph C(G);
+            for (std::size_t k = q; k < deletions.size() && k < q + 1 + mt() % 4; ++k)
+            {
+                batch.push_back(edge(deletions[k].first, deletions[k].second, G).first);
+                remove_edge(deletions[k].first, deletions[k].second, C);
+            }
+            Vertex x = vertex(mt() % num_vertices(G), G);
+            Vertex y = (mt() % 2) ? u : vertex(mt() % num_vertices(G), G);
+            assert(DG.would_disconnect(batch, x, y) == !my::dfs_scan(C, x, y));
+            assert(same_structure(G, DG, G_ref, reference));
+        }
+
+        // e is still a valid descriptor, the real deletion has to agree
+        if (q % 2 == 0)
+        {
+            DG.dyn_remove_edge(e);
+        }
+        else
+        {
+            bool removed = DG.dyn_remove_edge(u, v);
+            assert(removed);
+        }
+        reference.dyn_remove_edge(edge(u, v, G_ref).first);
+        assert(disconnects == !DG.query_is_connected(u, v));
+        assert(same_structure(G, DG, G_ref, reference));
+    }
+    std::cout << "Success" << std::endl;
+}
+
+// same_state checks that the fork answers like the DynGraph that made the same deletions for real
+bool same_state(DynGraphFork &F, DynGraph &DG, std::size_t n)
+{
+    for (Vertex w = 0; w < n; ++w)
+    {
+        if (F.level(w) != DG._levels[w] || F.component(w) != DG._components[w])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_fork(mt19937 &mt, ReorgEngine engine)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing forks with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... " << std::flush;
+
+    // each fork is checked against a copy of the graph and of the structure, the parent against one left untouched
+    Graph G_ref(G);
+    Graph G_copy(G);
+    Vertex r = vertex(mt() % num_vertices(G), G);
+    DynGraph DG(G, r);
+    DynGraph reference(G_ref, r);
+    DynGraph copy(G_copy, r);
+    DG.set_engine(engine);
+    copy.set_engine(engine);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    std::size_t half = deletions.size() / 2;
+    {
+        DynGraphFork first = DG.fork();
+        for (std::size_t q = 0; q < half; ++q)
+        {
+            Vertex u = deletions[q].first;
+            Vertex v = deletions[q].second;
+            bool removed = first.dyn_remove_edge(u, v);
+            bool removed_again = first.dyn_remove_edge(u, v);
+            assert(removed && !removed_again && "The edge has already been deleted in the fork.");
+            copy.dyn_remove_edge(edge(u, v, G_copy).first);
+            assert(first.query_is_connected(u, v) == copy.query_is_connected(u, v));
+            if (q % 8 == 0)
+            {
+                // the parent takes its state back, the next deletion puts the one of the fork in place again
+                assert(DG.query_is_connected(u, v) == reference.query_is_connected(u, v));
+            }
+        }
+        assert(same_state(first, copy, num_vertices(G)) && first.deleted_edges() == half);
+        // the deleted edges of the fork are out of the graph until the parent takes it back
+        DG.reclaim_state();
+        assert(same_structure(G, DG, G_ref, reference));
+
+        // a fork of the fork carries on, through descriptors of the shared graph, and leaves the first one as it was
+        std::vector<int> levels(num_vertices(G));
+        for (Vertex w = 0; w < num_vertices(G); ++w)
+        {
+            levels[w] = first.level(w);
+        }
+        DynGraphFork second = first.fork();
+        for (std::size_t q = half; q < deletions.size(); ++q)
+        {
+            Vertex u = deletions[q].first;
+            Vertex v = deletions[q].second;
+            second.dyn_remove_edge(edge(u, v, G).first);
+            copy.dyn_remove_edge(edge(u, v, G_copy).first);
+            assert(second.query_is_connected(u, v) == copy.query_is_connected(u, v));
+        }
+        assert(same_state(second, copy, num_vertices(G)));
+        for (Vertex w = 0; w < num_vertices(G); ++w)
+        {
+            assert(first.level(w) == levels[w]);
+        }
+
+        // a fork of the parent starts from its state, not from the one of the other forks
+        DynGraphFork third = DG.fork();
+        assert(third.touched_vertices() == 0 && same_state(third, reference, num_vertices(G)));
+        assert(same_structure(G, DG, G_ref, reference));
+    }
+
+    // once the forks are gone the parent can be changed again
+    for (std::size_t q = 0; q < half; ++q)
+    {
+        DG.dyn_remove_edge(edge(deletions[q].first, deletions[q].second, G).first);
+        assert(DG.query_is_connected(deletions[q].first, deletions[q].second) ==
+               my::dfs_scan(G, deletions[q].first, deletions[q].second));
+    }
+    std::cout << "Success" << std::endl;
+}
+
+// check_forest checks that the spanning forest of DG has one edge of G to the level above per vertex but one per component
+void check_forest(Graph &G, DynGraph &DG)
+{
+    std::size_t edges = 0;
+    std::set<int> components(DG._components.begin(), DG._components.end());
+    SpanningForest forest = DG.spanning_forest();
+    for (auto it = forest.begin(); it != forest.end(); ++it)
+    {
+        assert(edge(it->first, it->second, G).second && DG._levels[it->second] == DG._levels[it->first] - 1);
+        ++edges;
+    }
+    // every vertex but the tops has exactly one parent, one level closer to the top: a forest, one tree per component
+    assert(edges + components.size() == num_vertices(G));
+}
+
+// check_path checks the connecting path between u and v against G
+void check_path(Graph &G, DynGraph &DG, Vertex u, Vertex v)
+{
+    std::vector<Vertex> path = DG.connecting_path(u, v);
+    if (!DG.query_is_connected(u, v))
+    {
+        assert(path.empty());
+        return;
+    }
+    assert(path.front() == u && path.back() == v);
+    assert(path.size() <= static_cast<std::size_t>(DG._levels[u] + DG._levels[v] + 1));
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        assert(edge(path[i - 1], path[i], G).second);
+    }
+}
+
+void test_connecting_path(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing connecting paths with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    DynGraph DG(G, vertex(mt() % num_vertices(G), G));
+    check_forest(G, DG);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    for (std::size_t q = 0; q < deletions.size(); ++q)
+    {
+        Vertex u = deletions[q].first;
+        Vertex v = deletions[q].second;
+        DG.dyn_remove_edge(u, v);
+        check_path(G, DG, u, v);
+        check_path(G, DG, vertex(mt() % num_vertices(G), G), vertex(mt() % num_vertices(G), G));
+        check_path(G, DG, u, u);
+        if (q % 64 == 0)
+        {
+            // the components that broke off keep a tree of their own
+            check_forest(G, DG);
+        }
+    }
+    check_forest(G, DG);
+    std::cout << "Success" << std::endl;
+}
+
+void test_reorder(mt19937 &mt)
+{
+    Graph G;
+    std::vector<Edge> edge_handles;
+    auto num_of_vertices = mt() % MAX_RANDOM_VERTICES + 1;
+    auto num_of_edges = mt() % MAX_RANDOM_EDGES + 1;
+    gen::generate_random(G, num_of_vertices, num_of_edges, edge_handles, mt);
+    std::cout << "Testing vertex reordering with " << num_vertices(G) << " vertices and " << num_edges(G) << " edges... "
+              << std::flush;
+
+    const VertexOrder orders[4] = {VertexOrder::Identity, VertexOrder::Bfs, VertexOrder::ReverseCuthillMcKee,
+                                   VertexOrder::Degree};
+    Vertex r = vertex(mt() % num_vertices(G), G);
+    std::vector<std::pair<Vertex, Vertex>> deletions = gen::deletion_sequence(G, mt);
+    for (int o = 0; o < 4; ++o)
+    {
+        ReorderedDynGraph RDG(G, orders[o], r);
+        assert(RDG.get_root() == r && num_edges(RDG.graph()) == num_edges(G));
+        for (Vertex v = 0; v < num_vertices(G); ++v)
+        {
+            assert(RDG.to_external(RDG.to_internal(v)) == v);
+        }
+        // the answers are checked on the original graph, in original ids
+        Graph G_check(G);
+        for (auto it = deletions.begin(); it != deletions.end(); ++it)
+        {
+            bool removed = RDG.dyn_remove_edge(it->first, it->second);
+            assert(removed);
+            remove_edge(edge(it->first, it->second, G_check).first, G_check);
+            assert(RDG.query_is_connected(it->first, it->second) == my::dfs_scan(G_check, it->first, it->second));
+        }
+    }
+
+    // on a randomly numbered path, RCM restores consecutive ids along the path
+    const int n = 200;
+    std::vector<Vertex> label(n);
+    for (int i = 0; i < n; ++i)
+    {
+        label[i] = i;
+    }
+    for (int i = n - 1; i > 0; --i)
+    {
+        std::swap(label[i], label[mt() % (i + 1)]);
+    }
+    Graph path(n);
+    for (int i = 1; i < n; ++i)
+    {
+        add_edge(label[i - 1], label[i], path);
+    }
+    std::vector<Vertex> new_id = my::vertex_order(path, VertexOrder::ReverseCuthillMcKee);
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(path); ei != eiend; ++ei)
+    {
+        long d = static_cast<long>(new_id[source(*ei, path)]) - static_cast<long>(new_id[target(*ei, path)]);
+        assert(std::abs(d) == 1 && "RCM should give a path bandwidth 1.");
+    }
+    std::cout << "Success" << std::endl;
+}
+
 int main()
 {
     // Get the current timestamp using high_resolution_clock
@@ -209,5 +1595,34 @@ int main()
     test_random_no_assert(mt);
     test_random_connected(mt);
     test_fully_connected(mt);
+    test_reorg_variant(mt, my::StepScheduler(8, 4, 1), ReorgEngine::StateMachine, "fixed 4:1 scheduler");
+    test_reorg_variant(mt, my::StepScheduler(16, 1, 1, my::SchedulePolicy::Adaptive), ReorgEngine::StateMachine, "adaptive scheduler");
+    test_reorg_variant(mt, my::StepScheduler(), ReorgEngine::Coroutine, "coroutine engine");
+    test_reorg_variant(mt, my::StepScheduler(16, 1, 1, my::SchedulePolicy::Adaptive), ReorgEngine::Coroutine, "coroutine engine with adaptive scheduler");
+    test_root_strategies(mt);
+    test_background_rebuild(mt);
+    test_async(mt, false);
+    test_async(mt, true);
+    test_counters(mt, ReorgEngine::StateMachine);
+    test_counters(mt, ReorgEngine::Coroutine);
+    test_latency_histogram(mt);
+    test_offline(mt);
+    test_trace(mt);
+    test_phase_trace(mt, ReorgEngine::StateMachine);
+    test_phase_trace(mt, ReorgEngine::Coroutine);
+    test_memory_usage(mt);
+    test_generators(mt);
+    test_adversarial();
+    test_remove_by_endpoints(mt);
+    test_reorder(mt);
+    test_memory_policy(mt);
+    test_edge_set(mt);
+    test_compaction(mt);
+    test_shared_components(mt);
+    test_would_disconnect(mt, ReorgEngine::StateMachine);
+    test_would_disconnect(mt, ReorgEngine::Coroutine);
+    test_fork(mt, ReorgEngine::StateMachine);
+    test_fork(mt, ReorgEngine::Coroutine);
+    test_connecting_path(mt);
     return 0;
 }
@@ -0,0 +1,280 @@
+#include "trace.hpp"
+#include "dyn_graph.hpp"
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace boost;
+
+namespace
+{
+    const char TRACE_MAGIC[4] = {'E', 'S', 'W', 'L'};
+
+    std::uint64_t mix(std::uint64_t h, std::uint64_t x)
+    {
+        // hash_combine step followed by the splitmix64 finalizer, order sensitive
+        h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    // read_varint returns false at the end of the input or on a truncated value
+    bool read_varint(std::istream &in, std::uint64_t &x)
+    {
+        x = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int c = in.get();
+            if (c == EOF)
+            {
+                return false;
+            }
+            x |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // read_fixed64 reads 8 bytes little endian
+    bool read_fixed64(std::istream &in, std::uint64_t &x)
+    {
+        x = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            int c = in.get();
+            if (c == EOF)
+            {
+                return false;
+            }
+            x |= static_cast<std::uint64_t>(c & 0xff) << (8 * i);
+        }
+        return true;
+    }
+
+    bool read_double(std::istream &in, double &x)
+    {
+        std::uint64_t bits;
+        if (!read_fixed64(in, bits))
+        {
+            return false;
+        }
+        std::memcpy(&x, &bits, sizeof(x));
+        return true;
+    }
+
+    // valid_ratio tells whether a scheduler setting read from a trace fits the int the scheduler keeps it in
+    bool valid_ratio(std::uint64_t x)
+    {
+        return x > 0 && x <= static_cast<std::uint64_t>(INT_MAX);
+    }
+}
+
+std::uint64_t my::graph_fingerprint(const Graph &G)
+{
+    std::uint64_t h = mix(0, num_vertices(G));
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(G); ei != eiend; ++ei)
+    {
+        h = mix(h, source(*ei, G));
+        h = mix(h, target(*ei, G));
+    }
+    return h;
+}
+
+my::TraceWriter::TraceWriter(const std::string &path, const Graph &G, Vertex root, std::uint64_t engine,
+                             const TraceSettings &settings)
+{
+    _out.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!_out)
+    {
+        return;
+    }
+    _out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    _write_varint(TRACE_VERSION);
+    _write_varint(engine);
+    _write_varint(num_vertices(G));
+    _write_varint(num_edges(G));
+    EdgeIterator ei, eiend;
+    for (tie(ei, eiend) = edges(G); ei != eiend; ++ei)
+    {
+        _write_varint(source(*ei, G));
+        _write_varint(target(*ei, G));
+    }
+    _write_fixed64(graph_fingerprint(G));
+    _write_varint(root);
+
+    const StepScheduler &scheduler = settings.scheduler;
+    _write_varint(static_cast<std::uint64_t>(scheduler.quantum()));
+    _write_varint(static_cast<std::uint64_t>(scheduler.ratio_a()));
+    _write_varint(static_cast<std::uint64_t>(scheduler.ratio_b()));
+    _write_varint(static_cast<std::uint64_t>(scheduler.policy()));
+    _write_varint(static_cast<std::uint64_t>(scheduler.max_ratio()));
+    _write_double(scheduler.a_win_rate());
+    _write_double(scheduler.avg_small_size());
+    _write_double(settings.reroot_drift_factor);
+    _write_varint(settings.reroot_min_deletions);
+    _write_varint(settings.reroot_strategy);
+    _write_double(settings.compact_min_load_factor);
+    _write_varint(settings.compact_per_deletion);
+    _write_varint(settings.compact_cursor);
+    _out.flush();
+}
+
+bool my::TraceWriter::is_open()
+{
+    return _out.is_open() && _out.good();
+}
+
+void my::TraceWriter::_write_varint(std::uint64_t x)
+{
+    while (x >= 0x80)
+    {
+        _out.put(static_cast<char>((x & 0x7f) | 0x80));
+        x >>= 7;
+    }
+    _out.put(static_cast<char>(x));
+}
+
+void my::TraceWriter::_write_fixed64(std::uint64_t x)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        _out.put(static_cast<char>((x >> (8 * i)) & 0xff));
+    }
+}
+
+void my::TraceWriter::_write_double(double x)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    _write_fixed64(bits);
+}
+
+void my::TraceWriter::record_deletion(Vertex v, Vertex u, bool breaks)
+{
+    _write_varint(v);
+    _write_varint((static_cast<std::uint64_t>(u) << 1) | (breaks ? 1 : 0));
+}
+
+void my::TraceWriter::flush()
+{
+    _out.flush();
+}
+
+bool my::read_trace(const std::string &path, WorkloadTrace &trace, std::string &error)
+{
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    char magic[4];
+    if (!in.read(magic, sizeof(magic)) || std::string(magic, 4) != std::string(TRACE_MAGIC, 4))
+    {
+        error = "not a workload trace";
+        return false;
+    }
+
+    std::uint64_t version, num_edges, x, y;
+    if (!read_varint(in, version) || version != TRACE_VERSION)
+    {
+        error = "unsupported trace version";
+        return false;
+    }
+    if (!read_varint(in, trace.engine) || !read_varint(in, trace.num_vertices) || !read_varint(in, num_edges))
+    {
+        error = "truncated header";
+        return false;
+    }
+    if (trace.engine > static_cast<std::uint64_t>(ReorgEngine::Coroutine))
+    {
+        error = "unknown engine";
+        return false;
+    }
+    trace.edges.clear();
+    for (std::uint64_t i = 0; i < num_edges; ++i)
+    {
+        if (!read_varint(in, x) || !read_varint(in, y) || x >= trace.num_vertices || y >= trace.num_vertices)
+        {
+            error = "truncated or invalid edge list";
+            return false;
+        }
+        trace.edges.push_back(std::make_pair(x, y));
+    }
+    if (!read_fixed64(in, trace.fingerprint))
+    {
+        error = "truncated header";
+        return false;
+    }
+    if (!read_varint(in, x) || (trace.num_vertices > 0 && x >= trace.num_vertices))
+    {
+        error = "truncated or invalid root";
+        return false;
+    }
+    trace.root = x;
+
+    TraceSettings &settings = trace.settings;
+    std::uint64_t quantum, ratio_a, ratio_b, policy, max_ratio;
+    double a_win_rate, avg_small_size;
+    if (!read_varint(in, quantum) || !read_varint(in, ratio_a) || !read_varint(in, ratio_b) || !read_varint(in, policy) ||
+        !read_varint(in, max_ratio) || !read_double(in, a_win_rate) || !read_double(in, avg_small_size) ||
+        !read_double(in, settings.reroot_drift_factor) || !read_varint(in, settings.reroot_min_deletions) ||
+        !read_varint(in, settings.reroot_strategy) || !read_double(in, settings.compact_min_load_factor) ||
+        !read_varint(in, settings.compact_per_deletion) || !read_varint(in, settings.compact_cursor))
+    {
+        error = "truncated settings";
+        return false;
+    }
+    // the scheduler asserts on settings it cannot run with, so they are checked before it is built
+    if (!valid_ratio(quantum) || !valid_ratio(ratio_a) || !valid_ratio(ratio_b) || !valid_ratio(max_ratio) ||
+        policy > static_cast<std::uint64_t>(SchedulePolicy::Adaptive))
+    {
+        error = "invalid scheduler settings";
+        return false;
+    }
+    settings.scheduler = StepScheduler(static_cast<int>(quantum), static_cast<int>(ratio_a), static_cast<int>(ratio_b),
+                                       static_cast<SchedulePolicy>(policy), static_cast<int>(max_ratio));
+    settings.scheduler.restore_averages(a_win_rate, avg_small_size);
+    // a random root is not written, a replay could not pick the same one
+    if (settings.reroot_strategy > static_cast<std::uint64_t>(RootStrategy::Center) ||
+        settings.reroot_strategy == static_cast<std::uint64_t>(RootStrategy::Random) ||
+        !std::isfinite(settings.reroot_drift_factor) || settings.reroot_drift_factor < 0.0 ||
+        !std::isfinite(settings.compact_min_load_factor) || settings.compact_min_load_factor < 0.0 ||
+        (settings.compact_cursor > 0 && settings.compact_cursor >= trace.num_vertices))
+    {
+        error = "invalid reroot or compaction settings";
+        return false;
+    }
+
+    trace.deletions.clear();
+    while (read_varint(in, x) && read_varint(in, y))
+    {
+        if (x >= trace.num_vertices || (y >> 1) >= trace.num_vertices)
+        {
+            error = "invalid deletion record";
+            return false;
+        }
+        TraceDeletion d = {static_cast<Vertex>(x), static_cast<Vertex>(y >> 1), (y & 1) != 0};
+        trace.deletions.push_back(d);
+    }
+    return true;
+}
+
+void my::build_graph(const WorkloadTrace &trace, Graph &G)
+{
+    assert(num_vertices(G) == 0);
+    for (std::uint64_t i = 0; i < trace.num_vertices; ++i)
+    {
+        add_vertex(G);
+    }
+    for (auto it = trace.edges.begin(); it != trace.edges.end(); ++it)
+    {
+        add_edge(it->first, it->second, G);
+    }
+}